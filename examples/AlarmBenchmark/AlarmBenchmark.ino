@@ -0,0 +1,69 @@
+/*
+  AlarmBenchmark
+
+  This sketch measures the cost of arming the RTC alarm.
+
+  The first arming after begin() goes through the HAL, which builds the
+  alarm structure and converts it to the register format. Alarms prepared
+  with prepareAlarm() are then re-armed by writing the alarm registers
+  directly.
+
+  Creation 18 Oct 2026
+  by STM32duino
+
+  This example code is in the public domain.
+
+  https://github.com/stm32duino/STM32RTC
+*/
+
+#include <STM32RTC.h>
+
+/* Get the rtc object */
+STM32RTC& rtc = STM32RTC::getInstance();
+
+/* Change this value to set the number of armings measured */
+const uint32_t loops = 100;
+
+STM32RTC::Alarm_Descriptor alarms[2];
+
+void setup()
+{
+  Serial.begin(9600);
+
+  // Select RTC clock source: LSI_CLOCK, LSE_CLOCK or HSE_CLOCK.
+  // By default the LSI is selected as source.
+  //rtc.setClockSource(STM32RTC::LSE_CLOCK);
+
+  rtc.begin(); // initialize RTC 24H format
+
+  STM32RTC::Alarm_Config config = {1, 1, 7, 30, 0, 0, STM32RTC::AM, STM32RTC::MATCH_HHMMSS};
+  rtc.prepareAlarm(alarms[0], config);
+  config.minutes = 45;
+  rtc.prepareAlarm(alarms[1], config);
+}
+
+void loop()
+{
+  uint32_t start, hal = 0, direct;
+
+  for (uint32_t i = 0; i < loops; i++) {
+    rtc.begin(); // The next arming goes through the HAL
+    start = micros();
+    rtc.enableAlarm(alarms[i & 1]);
+    hal += micros() - start;
+  }
+
+  start = micros();
+  for (uint32_t i = 0; i < loops; i++) {
+    // Alternate both alarms so that no arming is skipped as unchanged
+    rtc.enableAlarm(alarms[i & 1]);
+  }
+  direct = micros() - start;
+
+  rtc.disableAlarm();
+
+  Serial.printf("HAL arming   : %u us\n", (unsigned int)(hal / loops));
+  Serial.printf("Direct arming: %u us\n", (unsigned int)(direct / loops));
+
+  delay(5000);
+}
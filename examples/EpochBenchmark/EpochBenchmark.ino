@@ -0,0 +1,105 @@
+/*
+  EpochBenchmark
+
+  This sketch measures the cost of getEpoch() and compares it with
+  the full calendar conversion of the date and time using mktime().
+
+  getEpoch() only converts the date part when the date changes, so
+  most calls only need to read and convert the time of the day.
+
+  It also compares reading the date and time with the getters using
+  pointers and with getDateTime() returning a single value.
+
+  Creation 18 Oct 2026
+  by STM32duino
+
+  This example code is in the public domain.
+
+  https://github.com/stm32duino/STM32RTC
+*/
+
+#include <STM32RTC.h>
+#include <time.h>
+
+/* Get the rtc object */
+STM32RTC& rtc = STM32RTC::getInstance();
+
+/* Change this value to set the number of calls measured */
+const uint32_t loops = 10000;
+
+void setup()
+{
+  Serial.begin(9600);
+
+  // Select RTC clock source: LSI_CLOCK, LSE_CLOCK or HSE_CLOCK.
+  // By default the LSI is selected as source.
+  //rtc.setClockSource(STM32RTC::LSE_CLOCK);
+
+  rtc.begin(); // initialize RTC 24H format
+
+  rtc.setEpoch(1451606400); // Jan 1, 2016
+}
+
+void loop()
+{
+  uint32_t start, cached, full, pointers, value;
+  uint32_t epoch = 0;
+
+  start = micros();
+  for (uint32_t i = 0; i < loops; i++) {
+    epoch += rtc.getEpoch();
+  }
+  cached = micros() - start;
+
+  start = micros();
+  for (uint32_t i = 0; i < loops; i++) {
+    epoch += fullEpoch();
+  }
+  full = micros() - start;
+
+  start = micros();
+  for (uint32_t i = 0; i < loops; i++) {
+    uint8_t weekDay, day, month, year;
+    uint8_t hours, minutes, seconds;
+    rtc.getDate(&weekDay, &day, &month, &year);
+    rtc.getTime(&hours, &minutes, &seconds, nullptr);
+    epoch += day + hours + minutes + seconds;
+  }
+  pointers = micros() - start;
+
+  start = micros();
+  for (uint32_t i = 0; i < loops; i++) {
+    STM32RTC::DateTime now = rtc.getDateTime();
+    epoch += now.day() + now.hours() + now.minutes() + now.seconds();
+  }
+  value = micros() - start;
+
+  Serial.printf("getEpoch()   : %u ns/call\n", (unsigned int)((cached * 1000) / loops));
+  Serial.printf("mktime()     : %u ns/call\n", (unsigned int)((full * 1000) / loops));
+  Serial.printf("getDate/Time : %u ns/call\n", (unsigned int)((pointers * 1000) / loops));
+  Serial.printf("getDateTime(): %u ns/call\n", (unsigned int)((value * 1000) / loops));
+  Serial.printf("(checksum %u)\n", (unsigned int)epoch);
+
+  delay(5000);
+}
+
+uint32_t fullEpoch(void)
+{
+  struct tm tm;
+  uint8_t weekDay, day, month, year;
+  uint8_t hours, minutes, seconds;
+
+  rtc.getDate(&weekDay, &day, &month, &year);
+  rtc.getTime(&hours, &minutes, &seconds, nullptr);
+
+  tm.tm_isdst = -1;
+  tm.tm_yday = 0;
+  tm.tm_wday = 0;
+  tm.tm_year = year + 100;
+  tm.tm_mon = month - 1;
+  tm.tm_mday = day;
+  tm.tm_hour = hours;
+  tm.tm_min = minutes;
+  tm.tm_sec = seconds;
+  return mktime(&tm);
+}
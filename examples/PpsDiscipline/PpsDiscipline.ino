@@ -0,0 +1,74 @@
+/*
+  PpsDiscipline
+
+  This sketch disciplines the RTC with the pulse per second (PPS) output
+  of a GPS receiver.
+
+  Each edge is captured by the RTC time stamp input (RTC_TS pin), or by a
+  pin interrupt calling ppsEdge(). The calendar is shifted by whole RTC
+  ticks to keep the phase within one tick and the smooth calibration is
+  set from the frequency error fitted over up to 1024 seconds.
+
+  The phase resolution is one RTC tick: the prescalers are set for 32768
+  ticks per second (30.5 us) instead of 256, at the cost of a slightly
+  higher consumption. The seconds themselves have to be set from the time
+  messages of the receiver with setEpoch().
+
+  Creation 18 Oct 2026
+  by STM32duino
+
+  This example code is in the public domain.
+
+  https://github.com/stm32duino/STM32RTC
+*/
+
+#include <STM32RTC.h>
+
+/* Get the rtc object */
+STM32RTC& rtc = STM32RTC::getInstance();
+
+/* Change this value to use a pin interrupt instead of the RTC_TS pin */
+const bool useTimeStampInput = true;
+/* Pin connected to the PPS output when the time stamp input is not used */
+const uint32_t ppsPin = PA0;
+
+const char *stateNames[] = {"off", "acquiring", "tracking", "locked", "holdover"};
+
+void ppsInterrupt(void)
+{
+  rtc.ppsEdge();
+}
+
+void setup()
+{
+  Serial.begin(9600);
+
+  rtc.setClockSource(STM32RTC::LSE_CLOCK);
+  rtc.setPrediv(0, 32767);
+  rtc.begin(true); // reset the time to apply the prescalers
+
+  if (!useTimeStampInput) {
+    pinMode(ppsPin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(ppsPin), ppsInterrupt, RISING);
+  }
+  if (!rtc.enablePpsDiscipline(useTimeStampInput ? STM32RTC::PPS_TIMESTAMP_RISING : STM32RTC::PPS_INTERRUPT)) {
+    Serial.println("PPS discipline not available");
+  }
+}
+
+void loop()
+{
+  static uint32_t lastPrint = 0;
+
+  // At least once per second
+  rtc.updatePpsDiscipline();
+
+  if ((millis() - lastPrint) >= 10000) {
+    STM32RTC::Pps_Status status = rtc.getPpsStatus();
+    Serial.printf("%s: phase %d ns, frequency %d ppb, correction %d ppb, %u edges\n",
+                  stateNames[status.state], (int)status.phase, (int)status.frequency,
+                  (int)status.correction, (unsigned int)status.edges);
+    lastPrint = millis();
+  }
+  delay(100);
+}
@@ -0,0 +1,61 @@
+/*
+  TemperatureCompensation
+
+  This sketch compensates the frequency drift of the LSE crystal with
+  the temperature, read from the internal temperature sensor.
+
+  A 32.768 kHz tuning fork crystal slows down following a parabola
+  around its turnover temperature (typically -0.034 ppm/°C² around 25 °C).
+  The RTC smooth calibration is updated when the correction changes by
+  at least one calibration step (0.954 ppm).
+
+  Creation 18 Oct 2026
+  by STM32duino
+
+  This example code is in the public domain.
+
+  https://github.com/stm32duino/STM32RTC
+*/
+
+#include <STM32RTC.h>
+
+#define LL_ADC_RESOLUTION LL_ADC_RESOLUTION_12B
+
+/* Get the rtc object */
+STM32RTC& rtc = STM32RTC::getInstance();
+
+/* Change these values to match the crystal datasheet */
+const STM32RTC::Temperature_Model model = {2500, 34, nullptr, 0};
+
+/* Temperature in 0.01 °C */
+int32_t readTemperature(void *)
+{
+#if defined(__LL_ADC_CALC_VREFANALOG_VOLTAGE) && defined(__LL_ADC_CALC_TEMPERATURE)
+  int32_t vref = __LL_ADC_CALC_VREFANALOG_VOLTAGE(analogRead(AVREF), LL_ADC_RESOLUTION);
+  return __LL_ADC_CALC_TEMPERATURE(vref, analogRead(ATEMP), LL_ADC_RESOLUTION) * 100;
+#else
+  // No calibrated sensor: assume the turnover temperature
+  return model.turnover;
+#endif
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  analogReadResolution(12);
+
+  rtc.setClockSource(STM32RTC::LSE_CLOCK);
+  rtc.begin(); // initialize RTC 24H format
+
+  // Read the temperature every 10 minutes
+  rtc.enableTemperatureCompensation(model, readTemperature, nullptr, 600);
+}
+
+void loop()
+{
+  if (rtc.updateTemperatureCompensation()) {
+    Serial.printf("Temperature correction %d ppb, calibration %d ppb\n",
+                  (int)rtc.getTemperatureCorrection(), (int)rtc.getCalibration());
+  }
+  delay(1000);
+}
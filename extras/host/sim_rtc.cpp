@@ -0,0 +1,683 @@
+/*
+ * Simulated RTC driver layer for the host tests, see sim_rtc.h.
+ */
+#include "sim_rtc.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#define SECONDS_PER_DAY 86400
+#define BACKUP_COUNT    32
+
+typedef struct {
+  bool enabled;
+  uint8_t day;
+  uint8_t hours;
+  uint8_t minutes;
+  uint8_t seconds;
+  uint32_t subSeconds;
+  hourAM_PM_t period;
+  uint8_t mask;
+  voidCallbackPtr callback;
+  void *data;
+} simAlarm_t;
+
+static bool configured = false;
+static hourFormat_t hourFormat = HOUR_FORMAT_24;
+static uint32_t predivAsync = 127;
+static uint32_t ticksPerSecond = 256;
+
+/* RTC time: epoch seconds and fraction of the current second */
+static int64_t rtcSeconds = 946684800;
+static double rtcFraction = 0;
+static double trueTime = 0;
+static double crystalPpm = 0;
+static double latency = 0;
+static int32_t calibration = 0;
+
+static simAlarm_t alarmA;
+static simAlarm_t alarmB;
+static uint32_t alarmWrites = 0;
+static uint32_t alarmSkipped = 0;
+static voidCallbackPtr secondsCallback = NULL;
+static bool timeStampEnabled = false;
+static int32_t timeStampTicks = 0;
+static voidCallbackPtr timeStampCallback = NULL;
+static void *timeStampCallbackData = NULL;
+static uint32_t backup[BACKUP_COUNT];
+
+static uint32_t checks = 0;
+static uint32_t failures = 0;
+
+/* Calendar helpers ----------------------------------------------------------*/
+
+static void civilFromDays(int64_t days, uint32_t *year, uint8_t *month, uint8_t *day)
+{
+  days += 719468;
+  int64_t era = days / 146097;
+  uint32_t doe = (uint32_t)(days - era * 146097);
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  *day = doy - (153 * mp + 2) / 5 + 1;
+  *month = (mp < 10) ? (mp + 3) : (mp - 9);
+  *year = yoe + era * 400 + ((*month <= 2) ? 1 : 0);
+}
+
+static int64_t daysFromCivil(uint32_t year, uint32_t month, uint32_t day)
+{
+  year -= (month <= 2) ? 1 : 0;
+  int64_t era = year / 400;
+  uint32_t yoe = year - era * 400;
+  uint32_t doy = (153 * ((month > 2) ? (month - 3) : (month + 9)) + 2) / 5 + day - 1;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+/* 1-7, Monday first: 1st January 1970 is a Thursday */
+static uint8_t weekDay(int64_t days)
+{
+  return ((days + 3) % 7) + 1;
+}
+
+static uint8_t toRtcHours(uint8_t hours24, hourAM_PM_t *period)
+{
+  *period = (hours24 >= 12) ? HOUR_PM : HOUR_AM;
+  if (hourFormat == HOUR_FORMAT_12) {
+    hours24 %= 12;
+    return (hours24 == 0) ? 12 : hours24;
+  }
+  return hours24;
+}
+
+static uint8_t fromRtcHours(uint8_t hours, hourAM_PM_t period)
+{
+  if (hourFormat == HOUR_FORMAT_12) {
+    return (hours % 12) + ((period == HOUR_PM) ? 12 : 0);
+  }
+  return hours;
+}
+
+static uint32_t currentTick(void)
+{
+  return (uint32_t)floor(rtcFraction * ticksPerSecond);
+}
+
+/* Simulation ----------------------------------------------------------------*/
+
+static bool alarmMatch(const simAlarm_t *alarm, int64_t seconds, uint32_t tick)
+{
+  uint32_t alarmTick = (alarm->subSeconds < 1000) ? (alarm->subSeconds * ticksPerSecond) / 1000 : 0;
+  if (!alarm->enabled || (tick != alarmTick)) {
+    return false;
+  }
+  if (alarm->mask == OFF_MSK) {
+    return true;
+  }
+  int64_t days = seconds / SECONDS_PER_DAY;
+  uint32_t timeOfDay = seconds % SECONDS_PER_DAY;
+  uint32_t year;
+  uint8_t month, day;
+  civilFromDays(days, &year, &month, &day);
+  if ((alarm->mask & SS_MSK) && ((timeOfDay % 60) != alarm->seconds)) {
+    return false;
+  }
+  if ((alarm->mask & MM_MSK) && (((timeOfDay / 60) % 60) != alarm->minutes)) {
+    return false;
+  }
+  if ((alarm->mask & HH_MSK) && ((timeOfDay / 3600) != fromRtcHours(alarm->hours, alarm->period))) {
+    return false;
+  }
+  if (alarm->mask & D_MSK) {
+    if ((alarm->mask & WD_MSK) ? (weekDay(days) != alarm->day) : (day != alarm->day)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void interrupt(voidCallbackPtr callback, void *data)
+{
+  if (callback != NULL) {
+    // The interrupt is served after the latency, without new events
+    rtcFraction += latency;
+    while (rtcFraction >= 1) {
+      rtcFraction -= 1;
+      rtcSeconds++;
+    }
+    callback(data);
+  }
+}
+
+/* Events of the RTC entering a new tick */
+static void tickEvents(bool newSecond)
+{
+  uint32_t tick = currentTick();
+
+  if (alarmMatch(&alarmA, rtcSeconds, tick)) {
+    interrupt(alarmA.callback, alarmA.data);
+  }
+  if (alarmMatch(&alarmB, rtcSeconds, tick)) {
+    interrupt(alarmB.callback, alarmB.data);
+  }
+  if (newSecond) {
+    interrupt(secondsCallback, NULL);
+  }
+}
+
+void simAdvance(double seconds)
+{
+  double rate = 1 + ((crystalPpm * 1000) + calibration) * 1e-9;
+  bool events = alarmA.enabled || alarmB.enabled || (secondsCallback != NULL);
+  // Step by one tick at most when an event can happen
+  double step = events ? (1.0 / ticksPerSecond) : seconds;
+
+  while (seconds > 0) {
+    double dt = (seconds < step) ? seconds : step;
+    uint32_t tick = currentTick();
+    int64_t second = rtcSeconds;
+
+    seconds -= dt;
+    trueTime += dt;
+    rtcFraction += dt * rate;
+    while (rtcFraction >= 1) {
+      rtcFraction -= 1;
+      rtcSeconds++;
+    }
+    if (events && ((rtcSeconds != second) || (currentTick() != tick))) {
+      tickEvents(rtcSeconds != second);
+    }
+  }
+}
+
+void simSetEpoch(uint32_t epoch, uint32_t ticks)
+{
+  rtcSeconds = epoch;
+  rtcFraction = (double)ticks / ticksPerSecond;
+}
+
+uint32_t simGetEpoch(uint32_t *ticks)
+{
+  if (ticks != nullptr) {
+    *ticks = currentTick();
+  }
+  return (uint32_t)rtcSeconds;
+}
+
+double simTrueTime(void)
+{
+  return trueTime;
+}
+
+double simPhase(void)
+{
+  double phase = (double)(rtcSeconds % 1000) + rtcFraction - fmod(trueTime, 1000);
+  return phase - round(phase);
+}
+
+void simSetCrystalError(double ppm)
+{
+  crystalPpm = ppm;
+}
+
+void simSetInterruptLatency(double seconds)
+{
+  latency = seconds;
+}
+
+void simTimeStampEdge(void)
+{
+  if (timeStampEnabled) {
+    timeStampTicks = (int32_t)currentTick();
+    interrupt(timeStampCallback, timeStampCallbackData);
+  }
+}
+
+void simPowerLoss(void)
+{
+  configured = false;
+  alarmA.enabled = false;
+  alarmB.enabled = false;
+  calibration = 0;
+  for (uint32_t i = 0; i < BACKUP_COUNT; i++) {
+    backup[i] = 0;
+  }
+}
+
+bool simCheck(bool condition, const char *format, ...)
+{
+  checks++;
+  if (!condition) {
+    va_list args;
+    failures++;
+    printf("FAIL: ");
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+  }
+  return condition;
+}
+
+int simReport(const char *name)
+{
+  printf("%s: %u checks, %u failures\n", name, (unsigned)checks, (unsigned)failures);
+  return (failures == 0) ? 0 : 1;
+}
+
+/* Arduino core --------------------------------------------------------------*/
+
+uint32_t millis(void)
+{
+  return (uint32_t)(trueTime * 1000);
+}
+
+uint32_t micros(void)
+{
+  return (uint32_t)(trueTime * 1000000);
+}
+
+void __WFI(void)
+{
+  simAdvance(1.0 / ticksPerSecond);
+}
+
+/* Driver layer (rtc.h) ------------------------------------------------------*/
+
+void RTC_SetClockSource(sourceClock_t source)
+{
+  UNUSED(source);
+}
+
+void RTC_getPrediv(int8_t *asynch, int16_t *synch)
+{
+  *asynch = predivAsync;
+  *synch = ticksPerSecond - 1;
+}
+
+void RTC_setPrediv(int8_t asynch, int16_t synch)
+{
+  if ((asynch >= 0) && (synch >= 0)) {
+    predivAsync = asynch;
+    ticksPerSecond = synch + 1;
+  }
+}
+
+bool RTC_init(hourFormat_t format, sourceClock_t source, bool reset)
+{
+  bool reinit = reset || !configured;
+
+  UNUSED(source);
+  hourFormat = format;
+  if (reinit) {
+    configured = true;
+    rtcSeconds = 946684800;
+    rtcFraction = 0;
+    alarmA.enabled = false;
+    alarmB.enabled = false;
+  }
+  return reinit;
+}
+
+void RTC_DeInit(void)
+{
+  alarmA.callback = NULL;
+  alarmB.callback = NULL;
+  secondsCallback = NULL;
+  timeStampCallback = NULL;
+}
+
+bool RTC_IsConfigured(void)
+{
+  return configured;
+}
+
+hourFormat_t RTC_GetHourFormat(void)
+{
+  return hourFormat;
+}
+
+uint32_t RTC_GetWakeReason(void)
+{
+  return RTC_WAKE_NONE;
+}
+
+void RTC_SetTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period)
+{
+  UNUSED(subSeconds);
+  rtcSeconds -= rtcSeconds % SECONDS_PER_DAY;
+  rtcSeconds += (fromRtcHours(hours, period) * 3600) + (minutes * 60) + seconds;
+  rtcFraction = 0;
+}
+
+void RTC_GetTime(uint8_t *hours, uint8_t *minutes, uint8_t *seconds, uint32_t *subSeconds, hourAM_PM_t *period)
+{
+  uint32_t timeOfDay = rtcSeconds % SECONDS_PER_DAY;
+  hourAM_PM_t p;
+
+  *hours = toRtcHours(timeOfDay / 3600, &p);
+  *minutes = (timeOfDay / 60) % 60;
+  *seconds = timeOfDay % 60;
+  if (subSeconds != NULL) {
+    *subSeconds = (currentTick() * 1000) / ticksPerSecond;
+  }
+  if (period != NULL) {
+    *period = p;
+  }
+}
+
+void RTC_SetDate(uint8_t year, uint8_t month, uint8_t day, uint8_t wday)
+{
+  UNUSED(wday);
+  rtcSeconds = (daysFromCivil(year + 2000, month, day) * SECONDS_PER_DAY) + (rtcSeconds % SECONDS_PER_DAY);
+}
+
+void RTC_GetDate(uint8_t *year, uint8_t *month, uint8_t *day, uint8_t *wday)
+{
+  int64_t days = rtcSeconds / SECONDS_PER_DAY;
+  uint32_t fullYear;
+
+  civilFromDays(days, &fullYear, month, day);
+  *year = fullYear - 2000;
+  *wday = weekDay(days);
+}
+
+/* Raw date: number of days since 1st January 1970 */
+uint32_t RTC_GetRawDate(void)
+{
+  return (uint32_t)(rtcSeconds / SECONDS_PER_DAY);
+}
+
+void RTC_DecodeRawDate(uint32_t rawDate, uint8_t *year, uint8_t *month, uint8_t *day)
+{
+  uint32_t fullYear;
+
+  civilFromDays(rawDate, &fullYear, month, day);
+  *year = fullYear - 2000;
+}
+
+void RTC_GetRawTime(rawTime_t *raw)
+{
+  raw->time = rtcSeconds % SECONDS_PER_DAY;
+  raw->date = RTC_GetRawDate();
+  raw->subSeconds = ticksPerSecond - 1 - currentTick();
+}
+
+void RTC_DecodeRawTime(const rawTime_t *raw, uint32_t *seconds, int32_t *ticks)
+{
+  *seconds = raw->time;
+  *ticks = (int32_t)ticksPerSecond - 1 - (int32_t)raw->subSeconds;
+}
+
+uint32_t RTC_GetTicksPerSecond(void)
+{
+  return ticksPerSecond;
+}
+
+static bool buildAlarm(simAlarm_t *alarm, uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds,
+                       uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+{
+  bool hoursValid = (hourFormat == HOUR_FORMAT_24) ? (hours <= 23) : ((hours >= 1) && (hours <= 12));
+  bool dayValid = (mask & WD_MSK) ? ((day >= 1) && (day <= 7)) : ((day >= 1) && (day <= 31));
+
+  if (!hoursValid || !dayValid || (minutes > 59) || (seconds > 59)) {
+    return false;
+  }
+  alarm->day = day;
+  alarm->hours = hours;
+  alarm->minutes = minutes;
+  alarm->seconds = seconds;
+  alarm->subSeconds = subSeconds;
+  alarm->period = (hourFormat == HOUR_FORMAT_24) ? HOUR_AM : period;
+  alarm->mask = mask;
+  return true;
+}
+
+void RTC_StartAlarm(uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+{
+  simAlarm_t alarm = alarmA;
+
+  if (buildAlarm(&alarm, day, hours, minutes, seconds, subSeconds, period, mask)) {
+    if (alarmA.enabled && (alarm.day == alarmA.day) && (alarm.hours == alarmA.hours) &&
+        (alarm.minutes == alarmA.minutes) && (alarm.seconds == alarmA.seconds) &&
+        (alarm.subSeconds == alarmA.subSeconds) && (alarm.period == alarmA.period) &&
+        (alarm.mask == alarmA.mask)) {
+      alarmSkipped++;
+      return;
+    }
+    alarmA = alarm;
+    alarmA.enabled = true;
+    alarmWrites++;
+  }
+}
+
+void RTC_StopAlarm(void)
+{
+  alarmA.enabled = false;
+}
+
+bool RTC_IsAlarmSet(void)
+{
+  return alarmA.enabled;
+}
+
+void RTC_GetAlarmStats(uint32_t *writes, uint32_t *skipped)
+{
+  if (writes != NULL) {
+    *writes = alarmWrites;
+  }
+  if (skipped != NULL) {
+    *skipped = alarmSkipped;
+  }
+}
+
+/* Register words: packed alarm fields, subseconds */
+bool RTC_BuildAlarmRegs(alarmRegs_t *regs, uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+{
+  simAlarm_t alarm;
+
+  if (!buildAlarm(&alarm, day, hours, minutes, seconds, subSeconds, period, mask)) {
+    return false;
+  }
+  regs->alrmar = ((uint32_t)mask << 24) | ((uint32_t)day << 16) | ((uint32_t)hours << 8) |
+                 ((uint32_t)minutes << 2) | ((alarm.period == HOUR_PM) ? 1 : 0);
+  regs->alrmassr = ((uint32_t)seconds << 16) | subSeconds;
+  return true;
+}
+
+bool RTC_StartAlarmRegs(const alarmRegs_t *regs)
+{
+  RTC_StartAlarm((regs->alrmar >> 16) & 0xFF, (regs->alrmar >> 8) & 0xFF, (regs->alrmar >> 2) & 0x3F,
+                 regs->alrmassr >> 16, regs->alrmassr & 0xFFFF, (regs->alrmar & 1) ? HOUR_PM : HOUR_AM,
+                 regs->alrmar >> 24);
+  return true;
+}
+
+void RTC_GetAlarm(uint8_t *day, uint8_t *hours, uint8_t *minutes, uint8_t *seconds, uint32_t *subSeconds, hourAM_PM_t *period, uint8_t *mask)
+{
+  *day = alarmA.day;
+  *hours = alarmA.hours;
+  *minutes = alarmA.minutes;
+  *seconds = alarmA.seconds;
+  *subSeconds = alarmA.subSeconds;
+  *period = alarmA.period;
+  *mask = alarmA.enabled ? alarmA.mask : (uint8_t)OFF_MSK;
+}
+
+void attachAlarmCallback(voidCallbackPtr func, void *data)
+{
+  alarmA.callback = func;
+  alarmA.data = data;
+}
+
+void detachAlarmCallback(void)
+{
+  alarmA.callback = NULL;
+  alarmA.data = NULL;
+}
+
+void RTC_StartAlarmB(uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+{
+  if (buildAlarm(&alarmB, day, hours, minutes, seconds, subSeconds, period, mask)) {
+    alarmB.enabled = true;
+  }
+}
+
+void RTC_StopAlarmB(void)
+{
+  alarmB.enabled = false;
+}
+
+uint32_t RTC_GetSubSecondTicks(uint32_t *ticks)
+{
+  if (ticks != NULL) {
+    *ticks = ticksPerSecond;
+  }
+  return currentTick();
+}
+
+void attachAlarmBCallback(voidCallbackPtr func, void *data)
+{
+  alarmB.callback = func;
+  alarmB.data = data;
+}
+
+void detachAlarmBCallback(void)
+{
+  alarmB.callback = NULL;
+  alarmB.data = NULL;
+}
+
+bool RTC_EnableTamper(uint8_t tamper, tamperTrigger_t trigger, uint8_t filter, uint16_t samplingDiv, uint8_t precharge, bool timeStamp, bool noErase)
+{
+  UNUSED(tamper);
+  UNUSED(trigger);
+  UNUSED(filter);
+  UNUSED(samplingDiv);
+  UNUSED(precharge);
+  UNUSED(timeStamp);
+  UNUSED(noErase);
+  return false;
+}
+
+void RTC_DisableTamper(uint8_t tamper)
+{
+  UNUSED(tamper);
+}
+
+bool RTC_GetTimeStamp(uint8_t *month, uint8_t *day, uint8_t *hours, uint8_t *minutes, uint8_t *seconds, uint32_t *subSeconds, hourAM_PM_t *period)
+{
+  UNUSED(month);
+  UNUSED(day);
+  UNUSED(hours);
+  UNUSED(minutes);
+  UNUSED(seconds);
+  UNUSED(subSeconds);
+  UNUSED(period);
+  return false;
+}
+
+void attachTamperCallback(tamperCallbackPtr func, void *data)
+{
+  UNUSED(func);
+  UNUSED(data);
+}
+
+void detachTamperCallback(void)
+{
+}
+
+bool RTC_EnableTimeStamp(bool fallingEdge)
+{
+  UNUSED(fallingEdge);
+  timeStampEnabled = true;
+  return true;
+}
+
+void RTC_DisableTimeStamp(void)
+{
+  timeStampEnabled = false;
+}
+
+int32_t RTC_GetTimeStampTicks(uint32_t *ticks)
+{
+  if (ticks != NULL) {
+    *ticks = ticksPerSecond;
+  }
+  return timeStampTicks;
+}
+
+void attachTimeStampCallback(voidCallbackPtr func, void *data)
+{
+  timeStampCallback = func;
+  timeStampCallbackData = data;
+}
+
+void detachTimeStampCallback(void)
+{
+  timeStampCallback = NULL;
+  timeStampCallbackData = NULL;
+}
+
+bool RTC_ShiftTicks(int32_t ticks)
+{
+  if ((ticks <= -(int32_t)ticksPerSecond) || (ticks >= (int32_t)ticksPerSecond)) {
+    return false;
+  }
+  rtcFraction += (double)ticks / ticksPerSecond;
+  if (rtcFraction >= 1) {
+    rtcFraction -= 1;
+    rtcSeconds++;
+  } else if (rtcFraction < 0) {
+    rtcFraction += 1;
+    rtcSeconds--;
+  }
+  return true;
+}
+
+uint32_t RTC_GetClockFrequency(void)
+{
+  return (predivAsync + 1) * ticksPerSecond;
+}
+
+/* Smooth calibration: pulses added or masked in 2^20 pulses */
+int32_t RTC_SetCalibration(int32_t ppb)
+{
+  int64_t scaled = (int64_t)ppb * 1048576;
+  int32_t pulses = (int32_t)((scaled + ((scaled < 0) ? -500000000 : 500000000)) / 1000000000);
+
+  if (pulses > 512) {
+    pulses = 512;
+  } else if (pulses < -511) {
+    pulses = -511;
+  }
+  calibration = (int32_t)(((int64_t)pulses * 1000000000) / 1048576);
+  return calibration;
+}
+
+int32_t RTC_GetCalibration(void)
+{
+  return calibration;
+}
+
+void attachSecondsIrqCallback(voidCallbackPtr func)
+{
+  secondsCallback = func;
+}
+
+void detachSecondsIrqCallback(void)
+{
+  secondsCallback = NULL;
+}
+
+void RTC_SetBackupWord(uint32_t index, uint32_t value)
+{
+  if (index < BACKUP_COUNT) {
+    backup[index] = value;
+  }
+}
+
+uint32_t RTC_GetBackupWord(uint32_t index)
+{
+  return (index < BACKUP_COUNT) ? backup[index] : 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * Simulated RTC driver layer for the host tests.
+ *
+ * sim_rtc.cpp implements the C API of src/rtc.h on a simulated calendar
+ * so that src/STM32RTC.cpp can be linked and run on the host. The RTC runs
+ * from the simulated true time with a crystal error and the calibration
+ * applied. Alarms A and B, the seconds interrupt and the time stamp input
+ * call the registered callbacks as the simulated time advances.
+ */
+#ifndef _SIM_RTC_H
+#define _SIM_RTC_H
+
+#include "rtc.h"
+
+/* Set the RTC time, 24 hours format, ticks of 1 / ticksPerSecond s */
+void simSetEpoch(uint32_t epoch, uint32_t ticks = 0);
+/* RTC time: epoch and ticks elapsed in the second */
+uint32_t simGetEpoch(uint32_t *ticks = nullptr);
+/* Advance the true time, calling the interrupt callbacks */
+void simAdvance(double seconds);
+/* True time in seconds since the start of the simulation */
+double simTrueTime(void);
+/* RTC phase in seconds against the true time, modulo one second */
+double simPhase(void);
+/* Crystal frequency error in ppm, positive when the RTC is fast */
+void simSetCrystalError(double ppm);
+/* Time stamp input edge at the current time */
+void simTimeStampEdge(void);
+/* Loss of the backup domain: RTC reset and backup registers cleared */
+void simPowerLoss(void);
+/* Interrupt latency added to the time stamp of the alarm callbacks */
+void simSetInterruptLatency(double seconds);
+
+/* Report a check result, counted by simReport() */
+bool simCheck(bool condition, const char *format, ...);
+/* Print the result of the checks and return the exit status */
+int simReport(const char *name);
+
+#endif /* _SIM_RTC_H */
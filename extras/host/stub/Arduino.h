@@ -0,0 +1,13 @@
+/*
+ * Host stub of the Arduino core: only what the library uses.
+ */
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include "stm32_def.h"
+#include <string.h>
+
+uint32_t millis(void);
+uint32_t micros(void);
+
+#endif /* _HOST_ARDUINO_H */
@@ -0,0 +1,8 @@
+/*
+ * Host stub of the core backup domain helpers: not used by the simulated
+ * RTC driver.
+ */
+#ifndef _HOST_BACKUP_H
+#define _HOST_BACKUP_H
+
+#endif /* _HOST_BACKUP_H */
@@ -0,0 +1,14 @@
+/*
+ * Host stub of the core clock helpers.
+ */
+#ifndef _HOST_CLOCK_H
+#define _HOST_CLOCK_H
+
+typedef enum {
+  LSI_CLOCK,
+  HSI_CLOCK,
+  LSE_CLOCK,
+  HSE_CLOCK
+} sourceClock_t;
+
+#endif /* _HOST_CLOCK_H */
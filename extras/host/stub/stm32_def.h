@@ -0,0 +1,77 @@
+/*
+ * Host stub of the core definitions: an STM32L4xx like RTC with alarm B,
+ * subseconds, synchronization shift, smooth calibration, tamper, time
+ * stamp and wake up timer. Only the definitions used by rtc.h and
+ * STM32RTC.cpp are provided: the driver layer is simulated by sim_rtc.cpp.
+ */
+#ifndef _HOST_STM32_DEF_H
+#define _HOST_STM32_DEF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define STM32_CORE_VERSION      0x02000000
+#define STM32L4xx
+#define HAL_RTC_MODULE_ENABLED
+
+#define UNUSED(x) ((void)(x))
+
+typedef enum {
+  TAMP_STAMP_IRQn = 2,
+  RTC_WKUP_IRQn = 3,
+  RTC_Alarm_IRQn = 41
+} IRQn_Type;
+
+#define RTC_PRER_PREDIV_A_Pos   16
+#define RTC_PRER_PREDIV_A       (0x7FUL << RTC_PRER_PREDIV_A_Pos)
+#define RTC_PRER_PREDIV_S_Pos   0
+#define RTC_PRER_PREDIV_S       (0x7FFFUL << RTC_PRER_PREDIV_S_Pos)
+#define RTC_SSR_SS              0xFFFFUL
+#define RTC_SHIFTR_SUBFS        0x7FFFUL
+#define RTC_CALR_CALP           (1UL << 15)
+#define RTC_CR_WUTE             (1UL << 10)
+
+#define RTC_ALARM_A             0x100
+#define RTC_ALARM_B             0x200
+#define RTC_TAMPER_1            1
+#define RTC_TIMESTAMPPIN_DEFAULT 0
+
+#define RTC_WEEKDAY_MONDAY      1
+#define RTC_WEEKDAY_TUESDAY     2
+#define RTC_WEEKDAY_WEDNESDAY   3
+#define RTC_WEEKDAY_THURSDAY    4
+#define RTC_WEEKDAY_FRIDAY      5
+#define RTC_WEEKDAY_SATURDAY    6
+#define RTC_WEEKDAY_SUNDAY      7
+
+#define LL_RTC_BKP_DR0          0
+#define LL_RTC_BKP_DR1          1
+#define LL_RTC_BKP_DR2          2
+#define LL_RTC_BKP_DR3          3
+#define LL_RTC_BKP_DR4          4
+#define LL_RTC_BKP_DR5          5
+#define LL_RTC_BKP_DR6          6
+#define LL_RTC_BKP_DR7          7
+#define LL_RTC_BKP_DR8          8
+#define LL_RTC_BKP_DR9          9
+#define LL_RTC_BKP_DR10         10
+#define LL_RTC_BKP_DR11         11
+#define LL_RTC_BKP_DR12         12
+#define LL_RTC_BKP_DR13         13
+#define LL_RTC_BKP_DR14         14
+#define LL_RTC_BKP_DR15         15
+#define LL_RTC_BKP_DR16         16
+#define LL_RTC_BKP_DR17         17
+#define LL_RTC_BKP_DR18         18
+#define LL_RTC_BKP_DR19         19
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void __WFI(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_STM32_DEF_H */
@@ -0,0 +1,112 @@
+/*
+ * Aging compensation of a +4 ppm crystal aging by +1.5 ppm per year, set
+ * from a reference every 30 days over 2 years. The RTC keeps the local time:
+ * the daylight saving time steps in between are not taken as drift, the
+ * correction of a wrong time setting is rejected, and the model survives a
+ * reset in the backup registers. The fitted correction follows the crystal
+ * and the time error at the synchronizations stays a small fraction of the
+ * uncompensated drift.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "STM32RTC.h"
+#include "sim_rtc.h"
+
+#define START      1700000000
+#define INTERVAL   30    // days between synchronizations
+#define SYNCS      24
+#define ERROR_PPM  4.0
+#define AGING_PPM  1.5   // per year
+#define ACCURACY   20    // ms
+#define DST_DAY    10
+#define WRONG_SYNC 7     // synchronization after a wrong time setting
+#define RESET_SYNC 12    // synchronization after a reset
+
+static STM32RTC &rtc = STM32RTC::getInstance();
+static int32_t local = 0; // local time offset, s
+
+/* Crystal frequency error in ppm at the current true time */
+static double crystalError(void)
+{
+  return ERROR_PPM + ((AGING_PPM * simTrueTime()) / (365.0 * 86400));
+}
+
+/* Advance to the next true second and set the RTC to the local time */
+static int32_t synchronize(void)
+{
+  uint32_t ms;
+
+  simAdvance(ceil(simTrueTime()) - simTrueTime());
+  uint32_t reference = START + (uint32_t)lround(simTrueTime()) + local;
+  uint32_t rtcTime = rtc.getEpoch(&ms);
+  int32_t offset = ((int32_t)(reference - rtcTime) * 1000) - (int32_t)ms;
+  rtc.setEpoch(reference);
+  rtc.setSyncSource(STM32RTC::SYNC_NETWORK, ACCURACY, offset);
+  return offset;
+}
+
+int main(void)
+{
+  double worst = 0;
+  double uncompensated = 0;
+
+  rtc.begin(true);
+  rtc.setAgingRate(0, false);
+  rtc.setEpoch(START);
+  rtc.setSyncSource(STM32RTC::SYNC_NETWORK, ACCURACY);
+
+  for (uint32_t sync = 1; sync <= SYNCS; sync++) {
+    int32_t before = 0;
+
+    for (uint32_t day = 0; day < INTERVAL; day++) {
+      simSetCrystalError(crystalError());
+      simAdvance(86400);
+      if (day == DST_DAY) {
+        // Daylight saving time: +1 hour then -1 hour on the next interval
+        int32_t step = (sync & 1) ? 3600 : -3600;
+        local += step;
+        rtc.setEpoch(rtc.getEpoch() + step);
+      }
+      if ((sync == WRONG_SYNC) && (day == 20)) {
+        rtc.setEpoch(rtc.getEpoch() + 600);
+      }
+      if ((sync == RESET_SYNC) && (day == 20)) {
+        int32_t rate = rtc.getAgingRate();
+        int32_t correction = rtc.getAgingCorrection();
+        rtc.begin();
+        simCheck(rtc.getAgingRate() == rate, "reset: rate %d ppb/year, %d before", (int)rtc.getAgingRate(),
+                 (int)rate);
+        simCheck(abs(rtc.getAgingCorrection() - correction) <= 5, "reset: correction %d ppb, %d before",
+                 (int)rtc.getAgingCorrection(), (int)correction);
+      }
+    }
+    if (sync == WRONG_SYNC) {
+      before = rtc.getAgingCorrection();
+    }
+
+    int32_t offset = synchronize();
+    uncompensated += crystalError() * 1e-6 * INTERVAL * 86400;
+    if (sync == WRONG_SYNC) {
+      // 10 minutes over 30 days: not a drift of the crystal
+      simCheck(rtc.getAgingCorrection() == before, "wrong setting: correction %d ppb, %d before",
+               (int)rtc.getAgingCorrection(), (int)before);
+      continue;
+    }
+    // Time error over the interval, once the model is fitted
+    if (sync > 4) {
+      worst = fmax(worst, fabs(offset / 1000.0));
+    }
+  }
+
+  double residual = crystalError() + (RTC_GetCalibration() / 1000.0);
+  printf("correction %d ppb, rate %d ppb/year, crystal %.3f ppm, residual %.3f ppm, worst error %.3f s"
+         " (uncompensated %.3f s)\n", (int)rtc.getAgingCorrection(), (int)rtc.getAgingRate(), crystalError(),
+         residual, worst, uncompensated / SYNCS);
+  simCheck(fabs((rtc.getAgingCorrection() / 1000.0) + crystalError()) < 0.5,
+           "correction %d ppb for a %.3f ppm crystal", (int)rtc.getAgingCorrection(), crystalError());
+  simCheck(abs(rtc.getAgingRate() + (int32_t)(AGING_PPM * 1000)) < 500, "rate %d ppb/year", (int)rtc.getAgingRate());
+  // One calibration step over the interval
+  simCheck(worst < 3.0, "worst error %.3f s", worst);
+  return simReport("test_aging");
+}
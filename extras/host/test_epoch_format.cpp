@@ -0,0 +1,49 @@
+/*
+ * Epoch_Format conversions, checked at compile time: NTP eras, origins
+ * before 1970 with sub-second units, and signed formats before their origin.
+ */
+#include "STM32RTC.h"
+#include "sim_rtc.h"
+
+typedef STM32RTC::Epoch_Format<int64_t, 1577836800> Epoch_2020_Signed;
+typedef STM32RTC::Epoch_Format<int64_t, 1577836800, 1000> Epoch_2020_Ms;
+typedef STM32RTC::Epoch_Format<uint64_t, -2208988800LL, 1000000> Ntp_Epoch_Us;
+
+// NTP era 0 and era 1 (from 2036-02-07 06:28:16)
+static_assert(STM32RTC::Ntp_Epoch::fromUnix(0, 0) == 2208988800u, "NTP origin");
+static_assert(STM32RTC::Ntp_Epoch::toUnix(3913056000u) == 1704067200u, "NTP era 0");
+static_assert(STM32RTC::Ntp_Epoch::toUnix(STM32RTC::Ntp_Epoch::fromUnix(2085978596u, 0)) == 2085978596u, "NTP era 1");
+// Origin before 1970 with a sub-second unit, up to the end of the RTC range
+static_assert(Ntp_Epoch_Us::fromUnix(0, 0) == 2208988800000000ull, "NTP us origin");
+static_assert(Ntp_Epoch_Us::toUnix(Ntp_Epoch_Us::fromUnix(4102444799u, 999)) == 4102444799u, "NTP us 2099");
+static_assert(Ntp_Epoch_Us::toSubSeconds(Ntp_Epoch_Us::fromUnix(4102444799u, 999)) == 999, "NTP us subseconds");
+// Before the origin: rounded down to the previous second
+static_assert(Epoch_2020_Signed::fromUnix(1577836799, 0) == -1, "2020 signed");
+static_assert(Epoch_2020_Signed::toUnix(-1) == 1577836799, "2020 signed");
+static_assert(Epoch_2020_Ms::fromUnix(1577836798, 500) == -1500, "2020 ms");
+static_assert(Epoch_2020_Ms::toUnix(-1500) == 1577836798, "2020 ms");
+static_assert(Epoch_2020_Ms::toSubSeconds(-1500) == 500, "2020 ms subseconds");
+// Predefined formats
+static_assert(STM32RTC::Unix_Epoch_Ms::fromUnix(1, 2) == 1002, "Unix ms");
+static_assert(STM32RTC::Y2k_Epoch::toUnix(0) == 946684800, "Y2K");
+static_assert(STM32RTC::Utc_1980_Epoch::toUnix(0) == 315964800, "UTC 1980");
+// 2024-01-01 00:00:00 UTC is the Monday of GPS week 2295, plus 18 leap seconds
+static_assert(STM32RTC::Gps_Epoch::fromUnix(1704067200, 0) == ((2295u * 604800) + 86400 + 18), "GPS");
+static_assert(STM32RTC::Gps_Epoch::toUnix((2295u * 604800) + 86400 + 18) == 1704067200, "GPS");
+
+static STM32RTC &rtc = STM32RTC::getInstance();
+
+int main(void)
+{
+  uint32_t subSeconds;
+
+  rtc.begin(true);
+  rtc.setEpoch<Epoch_2020_Ms>(-1500);
+  simCheck(rtc.getEpoch(&subSeconds) == 1577836798, "setEpoch<Epoch_2020_Ms>(-1500): %u", rtc.getEpoch());
+  // The subseconds of the time set are not written to the RTC
+  simCheck(rtc.getEpoch<Epoch_2020_Ms>() == -2000, "getEpoch<Epoch_2020_Ms>()");
+  rtc.setEpoch<STM32RTC::Ntp_Epoch>(3913056000u);
+  simCheck(rtc.getEpoch() == 1704067200u, "setEpoch<Ntp_Epoch>(): %u", rtc.getEpoch());
+  simCheck(rtc.getEpoch<STM32RTC::Ntp_Epoch>() == 3913056000u, "getEpoch<Ntp_Epoch>()");
+  return simReport("test_epoch_format");
+}
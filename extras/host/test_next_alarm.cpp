@@ -0,0 +1,143 @@
+/*
+ * getNextAlarmEpoch() against a brute force search of the next matching
+ * second, over random alarm configurations and dates in both hour formats.
+ * The predicted occurrence is then checked to fire the simulated alarm, and
+ * the interrupt to record the following one as the missed alarm target.
+ */
+#include <stdlib.h>
+#include <time.h>
+#include "STM32RTC.h"
+#include "sim_rtc.h"
+
+#define CONFIGS 2000
+
+static STM32RTC &rtc = STM32RTC::getInstance();
+static volatile uint32_t fired = 0;
+
+static void alarmMatch(void *data)
+{
+  UNUSED(data);
+  fired = simGetEpoch();
+}
+
+static bool matches(uint32_t ts, STM32RTC::Alarm_Match match, uint8_t day, uint8_t weekDay,
+                    uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+  time_t t = ts;
+  struct tm *tmp = gmtime(&t);
+  uint8_t tmWeekDay = (tmp->tm_wday == 0) ? 7 : tmp->tm_wday;
+
+  switch (match) {
+    case STM32RTC::MATCH_WDHHMMSS:
+      if (tmWeekDay != weekDay) {
+        return false;
+      }
+      break;
+    case STM32RTC::MATCH_DHHMMSS:
+      if (tmp->tm_mday != day) {
+        return false;
+      }
+      break;
+    default:
+      break;
+  }
+  switch (match) {
+    case STM32RTC::MATCH_WDHHMMSS:
+    case STM32RTC::MATCH_DHHMMSS:
+    case STM32RTC::MATCH_HHMMSS:
+      if (tmp->tm_hour != hours) {
+        return false;
+      }
+    // fall through
+    case STM32RTC::MATCH_MMSS:
+      if (tmp->tm_min != minutes) {
+        return false;
+      }
+    // fall through
+    default:
+      return tmp->tm_sec == seconds;
+  }
+}
+
+/* Next matching second, searched by day then by second in the day */
+static uint32_t bruteForce(uint32_t now, STM32RTC::Alarm_Match match, uint8_t day, uint8_t weekDay,
+                           uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+  uint32_t timeOfDay = (hours * 3600) + (minutes * 60) + seconds;
+
+  if ((match == STM32RTC::MATCH_SS) || (match == STM32RTC::MATCH_MMSS)) {
+    for (uint32_t ts = now + 1; ts <= now + 3600; ts++) {
+      if (matches(ts, match, day, weekDay, hours, minutes, seconds)) {
+        return ts;
+      }
+    }
+    return 0;
+  }
+  for (uint32_t ts = now - (now % 86400) + timeOfDay; ts < now + (400 * 86400); ts += 86400) {
+    if ((ts > now) && matches(ts, match, day, weekDay, hours, minutes, seconds)) {
+      return ts;
+    }
+  }
+  return 0;
+}
+
+int main(void)
+{
+  static const STM32RTC::Alarm_Match matchList[] = {
+    STM32RTC::MATCH_SS, STM32RTC::MATCH_MMSS, STM32RTC::MATCH_HHMMSS,
+    STM32RTC::MATCH_WDHHMMSS, STM32RTC::MATCH_DHHMMSS
+  };
+
+  srand(84);
+  for (uint32_t i = 0; i < CONFIGS; i++) {
+    STM32RTC::Hour_Format format = (i & 1) ? STM32RTC::HOUR_12 : STM32RTC::HOUR_24;
+    STM32RTC::Alarm_Match match = matchList[rand() % 5];
+    // Mostly the end of the months and the leap days
+    uint32_t now = 946684800 + ((uint32_t)rand() % (36500u * 86400u));
+    if (rand() & 1) {
+      time_t t = now;
+      struct tm *tmp = gmtime(&t);
+      now += ((28 - tmp->tm_mday) * 86400);
+    }
+    uint8_t day = (rand() & 1) ? (28 + (rand() % 4)) : (1 + (rand() % 31));
+    uint8_t weekDay = 1 + (rand() % 7);
+    uint8_t hours = rand() % 24;
+    uint8_t minutes = rand() % 60;
+    uint8_t seconds = rand() % 60;
+    uint8_t period = (hours >= 12) ? STM32RTC::PM : STM32RTC::AM;
+    uint8_t rtcHours = hours;
+
+    if (format == STM32RTC::HOUR_12) {
+      rtcHours = ((hours % 12) == 0) ? 12 : (hours % 12);
+    }
+    rtc.begin(true, format);
+    rtc.setEpoch(now);
+    if (match == STM32RTC::MATCH_WDHHMMSS) {
+      rtc.setAlarmWeekDay(weekDay);
+    } else {
+      rtc.setAlarmDay(day);
+    }
+    rtc.setAlarmTime(rtcHours, minutes, seconds, 0, (STM32RTC::AM_PM)period);
+    rtc.enableAlarm(match);
+
+    uint32_t expected = bruteForce(now, match, day, weekDay, hours, minutes, seconds);
+    uint32_t predicted = rtc.getNextAlarmEpoch();
+    if (!simCheck(predicted == expected, "config %u: now %u match 0x%02x day %u wday %u %02u:%02u:%02u:"
+                  " predicted %u expected %u", i, now, match, day, weekDay, hours, minutes, seconds,
+                  predicted, expected)) {
+      continue;
+    }
+
+    // The alarm fires at the prediction and not in the 2 seconds before
+    fired = 0;
+    rtc.attachInterrupt(alarmMatch);
+    simSetEpoch(predicted - 2);
+    simAdvance(2.5);
+    simCheck(fired == predicted, "config %u: fired at %u, predicted %u", i, fired, predicted);
+    uint32_t following = bruteForce(predicted, match, day, weekDay, hours, minutes, seconds);
+    uint32_t recorded = RTC_GetBackupWord(RTC_BKP_ALARM_TARGET);
+    simCheck(recorded == following, "config %u: recorded target %u, expected %u", i, recorded, following);
+    rtc.detachInterrupt();
+  }
+  return simReport("test_next_alarm");
+}
@@ -0,0 +1,106 @@
+/*
+ * PPS discipline on the simulated RTC: a fast or slow crystal with a slow
+ * frequency wander, edges at each true second captured by the time stamp
+ * input or by ppsEdge() after an interrupt latency, and a 10 minutes
+ * outage of the PPS signal. The phase stays within a few RTC ticks once
+ * locked, and the discipline holds over during the outage.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "STM32RTC.h"
+#include "sim_rtc.h"
+
+#define DURATION     (6 * 3600)
+#define OUTAGE_START (3 * 3600)
+#define OUTAGE       600
+#define WANDER       0.5  // ppm, 1 hour period
+#define LOCK_TIME    300  // s
+#define WINDOW_MAX   1024 // edges of the frequency fit
+
+static STM32RTC &rtc = STM32RTC::getInstance();
+
+static void run(const char *name, int16_t predivS, STM32RTC::Pps_Input input, double ppm)
+{
+  uint32_t ticksPerSecond = predivS + 1;
+  double tick = 1.0 / ticksPerSecond;
+  double maxLocked = 0;
+  double sumSquares = 0;
+  uint32_t locked = 0;
+  uint32_t firstLock = 0;
+  bool holdover = false;
+  bool relocked = false;
+
+  srand(100);
+  rtc.setPrediv((int8_t)((32768 / ticksPerSecond) - 1), predivS);
+  rtc.begin(true);
+  // RTC away from the PPS phase
+  simSetEpoch(1700000000, (uint32_t)(0.3712 * ticksPerSecond));
+  if (!simCheck(rtc.enablePpsDiscipline(input), "%s: discipline not enabled", name)) {
+    return;
+  }
+
+  for (uint32_t s = 1; s <= DURATION; s++) {
+    bool outage = (s >= OUTAGE_START) && (s < (OUTAGE_START + OUTAGE));
+    // Edge at the true second, interrupt latency 2 to 4 us
+    double latency = 3e-6 * (0.7 + ((0.6 * rand()) / RAND_MAX));
+
+    for (int step = 0; step < 10; step++) {
+      simSetCrystalError(ppm + (WANDER * sin((2 * M_PI * simTrueTime()) / 3600)));
+      simAdvance((step == 0) ? (0.1 - latency) : 0.1);
+      rtc.updatePpsDiscipline();
+    }
+    if (!outage) {
+      if (input == STM32RTC::PPS_INTERRUPT) {
+        simAdvance(latency);
+        rtc.ppsEdge();
+      } else {
+        simTimeStampEdge();
+        simAdvance(latency);
+      }
+    } else {
+      simAdvance(latency);
+    }
+    rtc.updatePpsDiscipline();
+
+    double phase = simPhase();
+    STM32RTC::Pps_State state = rtc.getPpsState();
+    if ((state == STM32RTC::PPS_LOCKED) && (firstLock == 0)) {
+      firstLock = s;
+    }
+    if (outage && (state == STM32RTC::PPS_HOLDOVER)) {
+      holdover = true;
+    }
+    if ((s > (OUTAGE_START + OUTAGE)) && (state == STM32RTC::PPS_LOCKED)) {
+      relocked = true;
+    }
+    // Locked phase, after 1 hour and out of the outage and its recovery
+    if ((s > 3600) && ((s < OUTAGE_START) || (s > (OUTAGE_START + OUTAGE + LOCK_TIME)))) {
+      maxLocked = fmax(maxLocked, fabs(phase));
+      sumSquares += phase * phase;
+      locked++;
+    }
+  }
+
+  double rms = sqrt(sumSquares / locked);
+  printf("%s: first lock %u s, max |phase| %.1f us, rms %.1f us, correction %d ppb\n", name,
+         (unsigned)firstLock, maxLocked * 1e6, rms * 1e6, (int)rtc.getPpsStatus().correction);
+  simCheck((firstLock != 0) && (firstLock < LOCK_TIME), "%s: first lock after %u s", name, (unsigned)firstLock);
+  // The phase is measured and shifted in whole ticks: 40 us with fine ticks, 1.5 tick with coarse ones
+  simCheck(maxLocked < fmax(1.5 * tick, 40e-6), "%s: max |phase| %.1f us", name, maxLocked * 1e6);
+  simCheck(rms < fmax(tick, 20e-6), "%s: rms %.1f us", name, rms * 1e6);
+  simCheck(holdover, "%s: no holdover during the outage", name);
+  simCheck(relocked, "%s: not locked again after the outage", name);
+  // The discipline correction cancels the crystal error, within the wander and one tick over the window
+  simCheck(fabs(rtc.getPpsStatus().correction + (ppm * 1000)) < ((WANDER * 1000) + fmax(1000, (tick * 1e9) / WINDOW_MAX)),
+           "%s: correction %d ppb for a %.1f ppm crystal", name, (int)rtc.getPpsStatus().correction, ppm);
+  rtc.disablePpsDiscipline();
+}
+
+int main(void)
+{
+  run("interrupt, 32768 ticks/s, +23.4 ppm", 32767, STM32RTC::PPS_INTERRUPT, 23.4);
+  run("time stamp, 32768 ticks/s, -60 ppm", 32767, STM32RTC::PPS_TIMESTAMP_RISING, -60);
+  run("interrupt, 256 ticks/s, +23.4 ppm", 255, STM32RTC::PPS_INTERRUPT, 23.4);
+  return simReport("test_pps");
+}
@@ -0,0 +1,103 @@
+/*
+ * scheduleAt() firing time: the action runs in the RTC tick of the target,
+ * and a target already reached in the current second is rejected instead of
+ * matching a month later. Also waitForSecondEdge() in both hour formats.
+ */
+#include "STM32RTC.h"
+#include "sim_rtc.h"
+
+#define T 1700000000
+
+static STM32RTC &rtc = STM32RTC::getInstance();
+static volatile bool fired = false;
+static uint32_t firedEpoch;
+static uint32_t firedTicks;
+static timeStamp_t firedStamp;
+
+static void action(const timeStamp_t *stamp, void *data)
+{
+  UNUSED(data);
+  fired = true;
+  firedEpoch = simGetEpoch(&firedTicks);
+  firedStamp = *stamp;
+}
+
+/* Schedule from the given RTC time and run until the callback or timeout */
+static bool scheduleFrom(uint32_t epoch, uint32_t ticks, uint32_t ts, uint32_t subSeconds, double timeout)
+{
+  fired = false;
+  simSetEpoch(epoch, ticks);
+  if (!rtc.scheduleAt(ts, subSeconds, action)) {
+    return false;
+  }
+  simAdvance(timeout);
+  return true;
+}
+
+static void checkFired(const char *name, uint32_t ts, uint32_t subSeconds)
+{
+  uint32_t ticksPerSecond = RTC_GetTicksPerSecond();
+  uint32_t target = (subSeconds * ticksPerSecond) / 1000;
+
+  if (simCheck(fired, "%s: not fired", name)) {
+    simCheck((firedEpoch == ts) && (firedTicks == target), "%s: fired at %u tick %u, expected %u tick %u",
+             name, firedEpoch, firedTicks, ts, target);
+    simCheck((firedStamp.epoch == ts) && ((subSeconds - firedStamp.subSeconds) <= ((1000 + ticksPerSecond - 1) / ticksPerSecond)),
+             "%s: time stamp %u.%03u, expected %u.%03u", name, firedStamp.epoch, firedStamp.subSeconds,
+             ts, subSeconds);
+  }
+}
+
+/* Wait for the next second from T.500 */
+static void checkSecondEdge(const char *name)
+{
+  uint32_t jitter;
+  uint32_t ticks;
+
+  simSetEpoch(T, 128);
+  uint32_t epoch = rtc.waitForSecondEdge(&jitter);
+  uint32_t now = simGetEpoch(&ticks);
+  simCheck(epoch == T + 1, "%s: second edge at %u, expected %u", name, epoch, T + 1);
+  simCheck((now == T + 1) && (ticks <= 1), "%s: returned at %u tick %u", name, now, ticks);
+}
+
+int main(void)
+{
+  rtc.begin(true);
+  checkSecondEdge("24h");
+
+  // RTC at T.500: the past subseconds of the current second are rejected
+  simCheck(!scheduleFrom(T, 128, T, 200, 0), "T.200 accepted at T.500");
+  simCheck(!scheduleFrom(T, 128, T, 500, 0), "T.500 accepted at T.500");
+  simCheck(!scheduleFrom(T, 128, T - 1, 800, 0), "T-1.800 accepted at T.500");
+  simCheck(scheduleFrom(T, 128, T, 800, 1), "T.800 rejected at T.500");
+  checkFired("T.800", T, 800);
+
+  // Next tick of the current second
+  simCheck(scheduleFrom(T, 128, T, 504, 1), "T.504 rejected at T.500");
+  checkFired("T.504", T, 504);
+
+  // Start of the next second
+  simCheck(scheduleFrom(T, 128, T + 1, 0, 2), "T+1.000 rejected at T.500");
+  checkFired("T+1.000", T + 1, 0);
+
+  // Across midnight and the end of the month: 2023-11-30 23:59:59.900
+  simCheck(scheduleFrom(1701388799, 230, 1701388800, 250, 1), "2023-12-01 rejected");
+  checkFired("2023-12-01", 1701388800, 250);
+
+  // Range
+  simCheck(!scheduleFrom(T, 0, T + (29 * 86400), 0, 0), "T+29 days accepted");
+  simCheck(scheduleFrom(T, 0, T + (27 * 86400), 0, 0), "T+27 days rejected");
+  rtc.cancelScheduleAt();
+  simCheck(!scheduleFrom(T, 0, T, 1000, 0), "subseconds 1000 accepted");
+
+  // 12 hours format: 2023-11-14 22:13:20 is 10 PM, and the edge wait arms
+  // its all masked alarm with a valid hour
+  rtc.begin(true, STM32RTC::HOUR_12);
+  checkSecondEdge("12h");
+  simCheck(scheduleFrom(T, 128, T, 800, 1), "12h: T.800 rejected at T.500");
+  checkFired("12h: T.800", T, 800);
+  simCheck(scheduleFrom(1701388799, 230, 1701388800, 250, 1), "12h: 2023-12-01 rejected");
+  checkFired("12h: 2023-12-01", 1701388800, 250);
+  return simReport("test_schedule_at");
+}
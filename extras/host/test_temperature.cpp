@@ -0,0 +1,83 @@
+/*
+ * Temperature compensation on a parabolic crystal: a daily temperature
+ * cycle from -20 to 40 °C over 4 days. The frequency error left after each
+ * update is within half a calibration step, and the time error stays a
+ * small fraction of the uncompensated drift.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "STM32RTC.h"
+#include "sim_rtc.h"
+
+#define START       1700000000
+#define DURATION    (4 * 86400)
+#define STEP        10
+#define HALF_STEP   477 // ppb
+#define TURNOVER    2500
+#define COEFFICIENT 34  // ppb/°C²
+
+static STM32RTC &rtc = STM32RTC::getInstance();
+static int32_t temperature; // 0.01 °C
+static bool temperatureRead;
+
+static int32_t readTemperature(void *data)
+{
+  UNUSED(data);
+  temperatureRead = true;
+  return temperature;
+}
+
+/* Crystal frequency error in ppb at the current temperature */
+static double crystalError(void)
+{
+  double delta = (temperature - TURNOVER) / 100.0;
+  return -(COEFFICIENT * delta * delta);
+}
+
+/* RTC time minus true time, in s */
+static double timeError(void)
+{
+  uint32_t ticks;
+  uint32_t epoch = simGetEpoch(&ticks);
+  return ((double)(epoch - START) + ((double)ticks / RTC_GetTicksPerSecond())) - simTrueTime();
+}
+
+int main(void)
+{
+  STM32RTC::Temperature_Model model = {TURNOVER, COEFFICIENT, nullptr, 0};
+  int32_t worst = 0;
+  uint32_t updates = 0;
+  double uncompensated = 0;
+
+  rtc.begin(true);
+  rtc.setEpoch(START);
+  double start = simTrueTime();
+  rtc.enableTemperatureCompensation(model, readTemperature, nullptr, 60);
+
+  for (uint32_t t = 0; t < DURATION; t += STEP) {
+    temperature = (int32_t)(1000 + (3000 * sin((2 * M_PI * t) / 86400)));
+    simSetCrystalError(crystalError() / 1000);
+    uncompensated += crystalError() * 1e-9 * STEP;
+    temperatureRead = false;
+    if (rtc.updateTemperatureCompensation()) {
+      updates++;
+    }
+    // Frequency error left right after the temperature read
+    int32_t residual = (int32_t)lround(crystalError()) + RTC_GetCalibration();
+    if (temperatureRead && (abs(residual) > abs(worst))) {
+      worst = residual;
+    }
+    simAdvance(STEP);
+  }
+
+  double error = timeError() + start;
+  printf("calibration updates %u, worst residual %d ppb, time error %.3f s (uncompensated %.3f s)\n",
+         (unsigned)updates, (int)worst, error, uncompensated);
+  simCheck(abs(worst) <= HALF_STEP, "residual %d ppb above half a step", (int)worst);
+  simCheck(rtc.getCalibration() == RTC_GetCalibration(), "calibration %d ppb, RTC %d ppb",
+           (int)rtc.getCalibration(), (int)RTC_GetCalibration());
+  simCheck(fabs(error) < (fabs(uncompensated) / 20), "time error %.3f s, uncompensated %.3f s", error,
+           uncompensated);
+  return simReport("test_temperature");
+}
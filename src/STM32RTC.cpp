@@ -40,10 +40,275 @@
 
 #define EPOCH_TIME_OFF      946684800  // This is 1st January 2000, 00:00:00 in epoch time
 #define EPOCH_TIME_YEAR_OFF 100        // years since 1900
+#define SECONDS_PER_DAY     86400
+#define SECONDS_PER_WEEK    (7 * SECONDS_PER_DAY)
+#define SECONDS_PER_YEAR    (365 * SECONDS_PER_DAY)
+
+// Typical accuracy of the RTC clock sources, used to estimate the drift
+#define LSE_DRIFT_PPM       20
+#define HSE_DRIFT_PPM       50
+#define LSI_DRIFT_PPM       50000
+
+#define SYNC_ACCURACY_MAX   0xFFFFFF
+
+// Half of the calibration resolution (1e9 / 2^20 ppb)
+#define CALIBRATION_HALF_STEP_PPB 477
+
+// Maximum error (ppb) of a drift observation to fit the aging model, and
+// maximum mean frequency error (ppb) of a plausible observation
+#define AGING_MAX_ERROR_PPB 1000
+#define AGING_MAX_RESIDUAL_PPB 30000
+// Aging word: correction (10 ppb) << 16 | fitted flag | rate (ppb/year, 15 bits)
+#define AGING_FITTED        0x8000
+#define AGING_RATE_MASK     0x7FFF
+#define AGING_RATE_MAX      0x3FFF
+#define AGING_BASE_MAX      327670
+
+// PPS discipline: averaging window (s), lock and holdover thresholds
+#define PPS_WINDOW_MIN      16
+#define PPS_WINDOW_MAX      1024
+#define PPS_LOCK_PPB        1000
+#define PPS_HOLDOVER_MS     3000
 
 // Initialize static variable
 bool STM32RTC::_timeSet = false;
 
+/**
+  * @brief  compute the number of days since 1st January 1970
+  * @param  year: full year (>= 1970)
+  * @param  month: 1-12
+  * @param  day: 1-31
+  * @retval number of days
+  */
+static uint32_t daysFromCivil(uint32_t year, uint32_t month, uint32_t day)
+{
+  return STM32RTC::DateTime::daysFromCivil(year, month, day);
+}
+
+/**
+  * @brief  compute the date from the number of days since 1st January 1970
+  * @param  days: number of days
+  * @param  year: full year
+  * @param  month: 1-12
+  * @retval none
+  */
+static void civilFromDays(uint32_t days, uint32_t *year, uint8_t *month)
+{
+  // Inverse of daysFromCivil(), the year starting in March
+  days += 719468;
+  uint32_t era = days / 146097;
+  uint32_t doe = days - era * 146097;
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  *month = (mp < 10) ? (mp + 3) : (mp - 9);
+  *year = yoe + era * 400 + ((*month <= 2) ? 1 : 0);
+}
+
+/**
+  * @brief  get the number of days of a month
+  * @param  year: full year
+  * @param  month: 1-12
+  * @retval number of days
+  */
+static uint8_t daysInMonth(uint32_t year, uint8_t month)
+{
+  if (month == 2) {
+    return (((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0))) ? 29 : 28;
+  }
+  return ((month == 4) || (month == 6) || (month == 9) || (month == 11)) ? 30 : 31;
+}
+
+/**
+  * @brief  compute the number of days since 1st January 1970 of a raw date
+  * @param  rawDate: raw date returned by RTC_GetRawDate()
+  * @retval number of days
+  */
+static uint32_t rawDateDays(uint32_t rawDate)
+{
+  uint8_t year, month, day;
+  RTC_DecodeRawDate(rawDate, &year, &month, &day);
+  return daysFromCivil(year + 2000, month, day);
+}
+
+/**
+  * @brief  read the epoch and the RTC ticks from a raw snapshot, without
+  *         updating the members
+  * @note   Safe to call from an interrupt.
+  * @param  ticks: pointer to where to store the ticks elapsed in the second
+  * @retval epoch time in seconds
+  */
+static uint32_t rawEpochTicks(int32_t *ticks)
+{
+  rawTime_t raw;
+  uint32_t seconds;
+  int32_t ticksPerSecond = RTC_GetTicksPerSecond();
+
+  RTC_GetRawTime(&raw);
+  RTC_DecodeRawTime(&raw, &seconds, ticks);
+  seconds += rawDateDays(raw.date) * SECONDS_PER_DAY;
+  // Out of the second after a shift operation
+  if (*ticks < 0) {
+    *ticks += ticksPerSecond;
+    seconds--;
+  } else if (*ticks >= ticksPerSecond) {
+    *ticks -= ticksPerSecond;
+    seconds++;
+  }
+  return seconds;
+}
+
+/**
+  * @brief  read the epoch from a raw snapshot, without updating the members
+  * @note   Safe to call from an interrupt.
+  * @param  subSeconds: optional (default: nullptr) pointer to where to store
+  *         subseconds of the epoch in ms
+  * @retval epoch time in seconds
+  */
+static uint32_t rawEpoch(uint32_t *subSeconds = nullptr)
+{
+  int32_t ticks;
+  uint32_t seconds = rawEpochTicks(&ticks);
+
+  if (subSeconds != nullptr) {
+    *subSeconds = (ticks * 1000) / (int32_t)RTC_GetTicksPerSecond();
+  }
+  return seconds;
+}
+
+/**
+  * @brief  convert hours to the 24 hours format
+  * @param  hours: 0-12 or 0-23 depending on format12
+  * @param  period: AM or PM, ignored if format12 is false
+  * @param  format12: true if hours are in 12 hours format
+  * @retval hours: 0-23
+  */
+static uint8_t toHours24(uint8_t hours, STM32RTC::AM_PM period, bool format12)
+{
+  if (format12) {
+    return (hours % 12) + ((period == STM32RTC::PM) ? 12 : 0);
+  }
+  return hours;
+}
+
+/**
+  * @brief  convert hours from the 24 hours format
+  * @param  hours: 0-23
+  * @param  period: pointer where return the period: AM or PM (always AM
+  *         if format12 is false)
+  * @param  format12: true to convert hours to the 12 hours format
+  * @retval hours: 1-12 or 0-23 depending on format12
+  */
+static uint8_t fromHours24(uint8_t hours, STM32RTC::AM_PM *period, bool format12)
+{
+  *period = (format12 && (hours >= 12)) ? STM32RTC::PM : STM32RTC::AM;
+  if (format12) {
+    hours %= 12;
+    return (hours == 0) ? 12 : hours;
+  }
+  return hours;
+}
+
+/**
+  * @brief  compute the next epoch matching an alarm configuration
+  * @note   Only integer math, no RTC access.
+  * @param  now: current epoch
+  * @param  match: alarm match (Alarm_Match value)
+  * @param  day: day of the month 1-31 for MATCH_DHHMMSS, day of the week
+  *         1-7 for MATCH_WDHHMMSS
+  * @param  timeOfDay: alarm time in seconds since midnight
+  * @retval next epoch strictly after now matching the alarm or 0 if the
+  *         alarm match is MATCH_OFF
+  */
+static uint32_t alarmEpochAfter(uint32_t now, uint8_t match, uint8_t day, uint32_t timeOfDay)
+{
+  uint32_t target;
+  uint32_t midnight = now - (now % SECONDS_PER_DAY);
+  // 1st January 1970 is a Thursday
+  uint8_t weekDay = (((now / SECONDS_PER_DAY) + 3) % 7) + 1;
+
+  switch (match) {
+    case STM32RTC::MATCH_SS:
+      target = now - (now % 60) + (timeOfDay % 60);
+      if (target <= now) {
+        target += 60;
+      }
+      break;
+    case STM32RTC::MATCH_MMSS:
+      target = now - (now % 3600) + (timeOfDay % 3600);
+      if (target <= now) {
+        target += 3600;
+      }
+      break;
+    case STM32RTC::MATCH_HHMMSS:
+      target = midnight + timeOfDay;
+      if (target <= now) {
+        target += SECONDS_PER_DAY;
+      }
+      break;
+    case STM32RTC::MATCH_WDHHMMSS:
+      target = midnight + (((day + 7 - weekDay) % 7) * SECONDS_PER_DAY) + timeOfDay;
+      if (target <= now) {
+        target += SECONDS_PER_WEEK;
+      }
+      break;
+    case STM32RTC::MATCH_YYMMDDHHMMSS://kept for compatibility
+    case STM32RTC::MATCH_MMDDHHMMSS:  //kept for compatibility
+    case STM32RTC::MATCH_DHHMMSS: {
+        // Months without the alarm day are skipped
+        if ((day < 1) || (day > 31)) {
+          target = 0;
+          break;
+        }
+        uint32_t year;
+        uint8_t month;
+        civilFromDays(now / SECONDS_PER_DAY, &year, &month);
+        uint32_t monthStart = daysFromCivil(year, month, 1) * SECONDS_PER_DAY;
+        target = 0;
+        while (target <= now) {
+          if (day <= daysInMonth(year, month)) {
+            target = monthStart + ((day - 1) * SECONDS_PER_DAY) + timeOfDay;
+          }
+          if (target <= now) {
+            monthStart += daysInMonth(year, month) * SECONDS_PER_DAY;
+            if (++month > 12) {
+              month = 1;
+              year++;
+            }
+          }
+        }
+      }
+      break;
+    default:
+      target = 0;
+      break;
+  }
+  return target;
+}
+
+#if defined(RTC_BKP_ALARM_TARGET)
+/**
+  * @brief  compute the next epoch matching the alarm A armed in the RTC
+  * @note   The alarm registers are read into locals, the alarm members are
+  *         not used: safe to call from an interrupt.
+  * @param  now: current epoch
+  * @retval next epoch strictly after now matching the alarm or 0 if the
+  *         alarm is not armed
+  */
+static uint32_t armedAlarmEpochAfter(uint32_t now)
+{
+  hourAM_PM_t period = HOUR_AM;
+  uint8_t day = 1;
+  uint8_t hours, minutes, seconds, mask;
+  uint32_t subSeconds;
+
+  RTC_GetAlarm(&day, &hours, &minutes, &seconds, &subSeconds, &period, &mask);
+  hours = toHours24(hours, (period == HOUR_AM) ? STM32RTC::AM : STM32RTC::PM,
+                    RTC_GetHourFormat() == HOUR_FORMAT_12);
+  return alarmEpochAfter(now, mask, day, (hours * 3600) + (minutes * 60) + seconds);
+}
+#endif /* RTC_BKP_ALARM_TARGET */
+
 /**
   * @brief initializes the RTC
   * @param format: hour format: HOUR_12 or HOUR_24(default)
@@ -80,14 +345,43 @@ void STM32RTC::begin(bool resetTime, Hour_Format format)
     syncDate();
     // Use current time to init alarm members
     _alarmDay  = _day;
+    _alarmWeekDay = _wday;
     _alarmHours = _hours;
     _alarmMinutes = _minutes;
     _alarmSeconds = _seconds;
     _alarmSubSeconds = _subSeconds;
     _alarmPeriod = _hoursPeriod;
+    _alarmMatch = MATCH_OFF;
   } else {
     _timeSet = true;
+    // Load the alarm configuration cache from the RTC
+    syncAlarmTime();
+  }
+#if defined(RTC_BKP_MONOTONIC_OFFSET)
+  _monotonicOffset = RTC_GetBackupWord(RTC_BKP_MONOTONIC_OFFSET);
+#endif /* RTC_BKP_MONOTONIC_OFFSET */
+#if defined(RTC_BKP_SYNC_EPOCH) && defined(RTC_BKP_SYNC_INFO)
+  if (reinit == true) {
+    // Time lost: the synchronization is no more valid
+    RTC_SetBackupWord(RTC_BKP_SYNC_INFO, SYNC_NONE);
+  }
+  _syncMonotonic = RTC_GetBackupWord(RTC_BKP_SYNC_EPOCH);
+  _syncInfo = RTC_GetBackupWord(RTC_BKP_SYNC_INFO);
+#else
+  if (reinit == true) {
+    _syncInfo = SYNC_NONE;
   }
+#endif /* RTC_BKP_SYNC_EPOCH && RTC_BKP_SYNC_INFO */
+#if defined(RTC_BKP_AGING)
+  uint32_t aging = RTC_GetBackupWord(RTC_BKP_AGING);
+  _agingBase = (int16_t)(aging >> 16) * 10;
+  _agingRate = ((int32_t)(aging << 17)) >> 17;
+  _agingFitted = ((aging & AGING_FITTED) != 0);
+#endif /* RTC_BKP_AGING */
+  _calibration = RTC_GetCalibration();
+  updateAlarmCallback();
+  checkMissedAlarm();
+  processAlarmQueue();
 }
 
 /**
@@ -125,6 +419,32 @@ void STM32RTC::setClockSource(Source_Clock source)
   }
 }
 
+/**
+  * @brief get the hour format used by the getters and setters.
+  * @retval hour format: HOUR_12 or HOUR_24
+  */
+STM32RTC::Hour_Format STM32RTC::getHourFormat(void)
+{
+  return _format;
+}
+
+/**
+  * @brief set the hour format used by the getters and setters.
+  * @note  The RTC keeps its own hour format, hours are converted when read
+  *        or written. The time is preserved and no RTC reinitialization is
+  *        required.
+  * @param format: hour format: HOUR_12 or HOUR_24
+  * @retval None
+  */
+void STM32RTC::setHourFormat(Hour_Format format)
+{
+  if (IS_HOUR_FORMAT(format) && (format != _format)) {
+    uint8_t hours = toHours24(_alarmHours, _alarmPeriod, _format == HOUR_12);
+    _format = format;
+    _alarmHours = fromHours24(hours, &_alarmPeriod, _format == HOUR_12);
+  }
+}
+
 #if defined(STM32F1xx)
 /**
   * @brief  get user asynchronous prescaler value for the current clock source.
@@ -191,22 +511,84 @@ void STM32RTC::enableAlarm(Alarm_Match match)
   switch (match) {
     case MATCH_OFF:
       RTC_StopAlarm();
+      recordAlarmTarget();
       break;
     case MATCH_YYMMDDHHMMSS://kept for compatibility
     case MATCH_MMDDHHMMSS:  //kept for compatibility
+    case MATCH_WDHHMMSS:
     case MATCH_DHHMMSS:
     case MATCH_HHMMSS:
     case MATCH_MMSS:
     case MATCH_SS:
-      RTC_StartAlarm(_alarmDay, _alarmHours, _alarmMinutes, _alarmSeconds,
-                     _alarmSubSeconds, (_alarmPeriod == AM) ? HOUR_AM : HOUR_PM,
-                     static_cast<uint8_t>(_alarmMatch));
+      startAlarm();
+      recordAlarmTarget();
       break;
     default:
       break;
   }
 }
 
+/**
+  * @brief precompute an alarm in RTC register format.
+  * @note  The descriptor depends on the hour format and the prescaler: it
+  *        must be prepared again after begin(), setHourFormat() or setPrediv().
+  * @param alarm: descriptor to fill
+  * @param config: alarm configuration, hours in the hour format set
+  * @retval false if the configuration is invalid
+  */
+bool STM32RTC::prepareAlarm(Alarm_Descriptor &alarm, const Alarm_Config &config)
+{
+  bool weekDay = (config.match & WD_MSK) != 0;
+
+  if ((config.hours > 23) || (config.minutes > 59) || (config.seconds > 59) ||
+      (weekDay && ((config.weekDay < 1) || (config.weekDay > 7))) ||
+      (!weekDay && ((config.day < 1) || (config.day > 31)))) {
+    return false;
+  }
+  alarm.config = config;
+#if !defined(STM32F1xx)
+  AM_PM period;
+  uint8_t hours = toHours24(config.hours, config.period, _format == HOUR_12);
+  hours = fromHours24(hours, &period, RTC_GetHourFormat() == HOUR_FORMAT_12);
+  return RTC_BuildAlarmRegs(&alarm.regs, weekDay ? config.weekDay : config.day,
+                            hours, config.minutes, config.seconds, config.subSeconds,
+                            (period == AM) ? HOUR_AM : HOUR_PM, static_cast<uint8_t>(config.match));
+#else
+  return true;
+#endif /* !STM32F1xx */
+}
+
+/**
+  * @brief enable the RTC alarm from a descriptor prepared by prepareAlarm().
+  * @note  Once the alarm has been armed after begin(), re-arming only writes
+  *        the alarm registers.
+  * @param alarm: precomputed alarm
+  * @retval None
+  */
+void STM32RTC::enableAlarm(const Alarm_Descriptor &alarm)
+{
+  _alarmDay = alarm.config.day;
+  _alarmWeekDay = alarm.config.weekDay;
+  _alarmHours = alarm.config.hours;
+  _alarmMinutes = alarm.config.minutes;
+  _alarmSeconds = alarm.config.seconds;
+  _alarmSubSeconds = alarm.config.subSeconds;
+  _alarmPeriod = alarm.config.period;
+  _alarmMatch = alarm.config.match;
+  _alarmCacheStale = false;
+  if (_alarmMatch == MATCH_OFF) {
+    RTC_StopAlarm();
+#if !defined(STM32F1xx)
+  } else if (!RTC_StartAlarmRegs(&alarm.regs)) {
+    startAlarm();
+#else
+  } else {
+    startAlarm();
+#endif /* !STM32F1xx */
+  }
+  recordAlarmTarget();
+}
+
 /**
   * @brief disable the RTC alarm.
   * @retval None
@@ -214,6 +596,21 @@ void STM32RTC::enableAlarm(Alarm_Match match)
 void STM32RTC::disableAlarm(void)
 {
   RTC_StopAlarm();
+  recordAlarmTarget();
+}
+
+/**
+  * @brief get the RTC alarm programming statistics.
+  * @note  enableAlarm() does not reprogram the RTC when the alarm is already
+  *        running with the same configuration.
+  * @param writes: pointer to the number of alarm hardware programmings
+  * @param skipped: optional (default: nullptr)
+  *        pointer to the number of alarm programmings skipped as unchanged
+  * @retval None
+  */
+void STM32RTC::getAlarmWriteStats(uint32_t *writes, uint32_t *skipped)
+{
+  RTC_GetAlarmStats(writes, skipped);
 }
 
 /**
@@ -223,7 +620,10 @@ void STM32RTC::disableAlarm(void)
   */
 void STM32RTC::attachInterrupt(voidFuncPtr callback, void *data)
 {
-  attachAlarmCallback(callback, data);
+  _alarmCallback = callback;
+  _alarmCallbackData = data;
+  updateAlarmCallback();
+  deliverMissedAlarm();
 }
 
 /**
@@ -232,7 +632,208 @@ void STM32RTC::attachInterrupt(voidFuncPtr callback, void *data)
   */
 void STM32RTC::detachInterrupt(void)
 {
-  detachAlarmCallback();
+  _alarmCallback = nullptr;
+  _alarmCallbackData = nullptr;
+  updateAlarmCallback();
+}
+
+/**
+  * @brief attach a RTC alarm callback receiving the time of the interrupt.
+  * @note  The time is read once at interrupt entry and shared with the
+  *        callback attached by attachInterrupt(), so the callback does not
+  *        need to read the RTC again.
+  * @param callback: pointer to the callback
+  * @param data: optional (default: nullptr) user data passed to the callback
+  * @retval None
+  */
+void STM32RTC::attachTimeStampInterrupt(timeStampFuncPtr callback, void *data)
+{
+  _alarmStampCallback = callback;
+  _alarmStampCallbackData = data;
+  updateAlarmCallback();
+}
+
+/**
+  * @brief detach the RTC alarm time stamp callback.
+  * @retval None
+  */
+void STM32RTC::detachTimeStampInterrupt(void)
+{
+  _alarmStampCallback = nullptr;
+  _alarmStampCallbackData = nullptr;
+  updateAlarmCallback();
+}
+
+/**
+  * @brief attach a callback called after each calendar write (setTime(),
+  *        setDate(), setEpoch(), ...).
+  * @note  The callback receives the epoch before and after the write and
+  *        the step in seconds, so that caches depending on the time can be
+  *        updated only when needed.
+  * @param callback: pointer to the callback
+  * @param data: optional (default: nullptr) user data passed to the callback
+  * @retval true if the callback has been attached
+  */
+bool STM32RTC::attachTimeChangeCallback(timeChangeFuncPtr callback, void *data)
+{
+  if ((callback == nullptr) || (_timeChangeCount >= RTC_TIME_CHANGE_CALLBACKS)) {
+    return false;
+  }
+  _timeChangeCallbacks[_timeChangeCount].callback = callback;
+  _timeChangeCallbacks[_timeChangeCount].data = data;
+  _timeChangeCount++;
+  return true;
+}
+
+/**
+  * @brief detach a time change callback.
+  * @param callback: pointer to the callback
+  * @retval None
+  */
+void STM32RTC::detachTimeChangeCallback(timeChangeFuncPtr callback)
+{
+  for (uint8_t i = 0; i < _timeChangeCount; i++) {
+    if (_timeChangeCallbacks[i].callback == callback) {
+      _timeChangeCount--;
+      _timeChangeCallbacks[i] = _timeChangeCallbacks[_timeChangeCount];
+      return;
+    }
+  }
+}
+
+/**
+  * @brief configure a tamper input and attach its callback.
+  * @note  Edge detection (filter 0) has no sampling cost. Level detection
+  *        samples the input at getTamperSamplingRate() and each sample
+  *        precharges the input for the precharge duration: both set the
+  *        consumption in low power mode.
+  *        Unless noErase is set, a tamper detection erases the backup
+  *        registers, including the ones used by the library.
+  * @param tamper: tamper input number (1-3 depending on the series)
+  * @param config: tamper configuration
+  * @param callback: pointer to the callback, it receives the tamper input
+  *        number and the time stamp of the detection (saved by the hardware
+  *        if config.timeStamp is set, else read at interrupt entry)
+  * @param data: optional (default: nullptr) user data passed to the callback
+  * @retval true if the configuration is supported
+  */
+bool STM32RTC::enableTamper(uint8_t tamper, const Tamper_Config &config, tamperFuncPtr callback, void *data)
+{
+#if defined(RTC_TAMPER_IRQn)
+  if ((tamper < 1) || (tamper > RTC_TAMPER_COUNT)) {
+    return false;
+  }
+  _tamperCallbacks[tamper - 1] = callback;
+  _tamperCallbacksData[tamper - 1] = data;
+  attachTamperCallback(tamperDispatch, nullptr);
+  if (!RTC_EnableTamper(tamper, static_cast<tamperTrigger_t>(config.trigger), config.filter,
+                        config.samplingDiv, config.precharge, config.timeStamp, config.noErase)) {
+    _tamperCallbacks[tamper - 1] = nullptr;
+    return false;
+  }
+  return true;
+#else
+  UNUSED(tamper);
+  UNUSED(config);
+  UNUSED(callback);
+  UNUSED(data);
+  return false;
+#endif /* RTC_TAMPER_IRQn */
+}
+
+/**
+  * @brief disable a tamper input and detach its callback.
+  * @param tamper: tamper input number (1-3 depending on the series)
+  * @retval None
+  */
+void STM32RTC::disableTamper(uint8_t tamper)
+{
+#if defined(RTC_TAMPER_IRQn)
+  if ((tamper >= 1) && (tamper <= RTC_TAMPER_COUNT)) {
+    RTC_DisableTamper(tamper);
+    _tamperCallbacks[tamper - 1] = nullptr;
+    _tamperCallbacksData[tamper - 1] = nullptr;
+  }
+#else
+  UNUSED(tamper);
+#endif /* RTC_TAMPER_IRQn */
+}
+
+/**
+  * @brief get the sampling rate of a tamper configuration.
+  * @param config: tamper configuration
+  * @retval number of samples per second, 0 for edge detection
+  */
+uint32_t STM32RTC::getTamperSamplingRate(const Tamper_Config &config)
+{
+  if ((config.filter == 0) || (config.samplingDiv == 0)) {
+    return 0;
+  }
+  return RTC_GetClockFrequency() / config.samplingDiv;
+}
+
+#if defined(RTC_TAMPER_IRQn)
+/**
+  * @brief  RTC tamper dispatcher, called on tamper interrupt.
+  * @param  tamper: tamper input number
+  * @param  data: not used
+  * @retval none
+  */
+void STM32RTC::tamperDispatch(uint8_t tamper, void *data)
+{
+  UNUSED(data);
+  STM32RTC &rtc = getInstance();
+  timeStamp_t stamp;
+  uint8_t month, day, hours, minutes, seconds;
+  hourAM_PM_t period;
+
+  if ((tamper < 1) || (tamper > RTC_TAMPER_COUNT) || (rtc._tamperCallbacks[tamper - 1] == nullptr)) {
+    return;
+  }
+  stamp.epoch = rawEpoch(&stamp.subSeconds);
+  if (RTC_GetTimeStamp(&month, &day, &hours, &minutes, &seconds, &stamp.subSeconds, &period)) {
+    // The time stamp has no year: it is the current one or the previous one
+    uint8_t year, curMonth, curDay;
+    RTC_DecodeRawDate(RTC_GetRawDate(), &year, &curMonth, &curDay);
+    uint32_t fullYear = year + 2000 - ((month > curMonth) ? 1 : 0);
+    hours = toHours24(hours, (period == HOUR_PM) ? PM : AM, RTC_GetHourFormat() == HOUR_FORMAT_12);
+    stamp.epoch = (daysFromCivil(fullYear, month, day) * SECONDS_PER_DAY) +
+                  (hours * 3600) + (minutes * 60) + seconds;
+  }
+  rtc._tamperCallbacks[tamper - 1](tamper, &stamp, rtc._tamperCallbacksData[tamper - 1]);
+}
+#endif /* RTC_TAMPER_IRQn */
+
+/**
+  * @brief attach a callback called when an alarm has been missed.
+  * @note  The target of the armed alarm is recorded in a backup register.
+  *        If it is found elapsed by begin(), the alarm has been missed (reset
+  *        or power down) and the callback is called with the lateness, as
+  *        soon as both the callback and begin() have been called.
+  *        If it is found elapsed when the alarm interrupt is handled, the
+  *        interrupt has been masked and occurrences have been lost: the
+  *        callback is called from the interrupt before the alarm callback.
+  * @param callback: pointer to the callback
+  * @param data: optional (default: nullptr) user data passed to the callback
+  * @retval None
+  */
+void STM32RTC::attachMissedAlarmCallback(missedAlarmFuncPtr callback, void *data)
+{
+  _missedAlarmCallback = callback;
+  _missedAlarmCallbackData = data;
+  updateAlarmCallback();
+  deliverMissedAlarm();
+}
+
+/**
+  * @brief detach the missed alarm callback.
+  * @retval None
+  */
+void STM32RTC::detachMissedAlarmCallback(void)
+{
+  _missedAlarmCallback = nullptr;
+  _missedAlarmCallbackData = nullptr;
+  updateAlarmCallback();
 }
 
 #ifdef ONESECOND_IRQn
@@ -243,7 +844,8 @@ void STM32RTC::detachInterrupt(void)
   */
 void STM32RTC::attachSecondsInterrupt(voidFuncPtr callback)
 {
-  attachSecondsIrqCallback(callback);
+  _secondsCallback = callback;
+  updateSecondsCallback();
 }
 
 /**
@@ -252,7 +854,68 @@ void STM32RTC::attachSecondsInterrupt(voidFuncPtr callback)
   */
 void STM32RTC::detachSecondsInterrupt(void)
 {
-  detachSecondsIrqCallback();
+  _secondsCallback = nullptr;
+  updateSecondsCallback();
+}
+
+/**
+  * @brief attach a RTC Seconds callback receiving the time of the interrupt.
+  * @note  The time is read once at interrupt entry.
+  * @param callback: pointer to the callback
+  * @param data: optional (default: nullptr) user data passed to the callback
+  * @retval None
+  */
+void STM32RTC::attachSecondsTimeStampInterrupt(timeStampFuncPtr callback, void *data)
+{
+  _secondsStampCallback = callback;
+  _secondsStampCallbackData = data;
+  updateSecondsCallback();
+}
+
+/**
+  * @brief detach the RTC Seconds time stamp callback.
+  * @retval None
+  */
+void STM32RTC::detachSecondsTimeStampInterrupt(void)
+{
+  _secondsStampCallback = nullptr;
+  _secondsStampCallbackData = nullptr;
+  updateSecondsCallback();
+}
+
+/**
+  * @brief  register the RTC Seconds callback: the user one when it is alone,
+  *         else the dispatcher.
+  * @retval none
+  */
+void STM32RTC::updateSecondsCallback(void)
+{
+  if (_secondsStampCallback != nullptr) {
+    attachSecondsIrqCallback(secondsDispatch);
+  } else if (_secondsCallback != nullptr) {
+    attachSecondsIrqCallback(_secondsCallback);
+  } else {
+    detachSecondsIrqCallback();
+  }
+}
+
+/**
+  * @brief  RTC Seconds dispatcher, called on Seconds interrupt.
+  * @param  data: not used
+  * @retval none
+  */
+void STM32RTC::secondsDispatch(void *data)
+{
+  STM32RTC &rtc = getInstance();
+  timeStamp_t stamp;
+
+  stamp.epoch = rawEpoch(&stamp.subSeconds);
+  if (rtc._secondsCallback != nullptr) {
+    rtc._secondsCallback(data);
+  }
+  if (rtc._secondsStampCallback != nullptr) {
+    rtc._secondsStampCallback(&stamp, rtc._secondsStampCallbackData);
+  }
 }
 
 #endif /* ONESECOND_IRQn */
@@ -266,6 +929,13 @@ void STM32RTC::standbyMode(void)
  * Get Functions
  */
 
+/*
+ * Alarm getters return the alarm configuration cached in RAM. It is loaded
+ * from the RTC by begin() and then only updated by the alarm setters, so
+ * no RTC access is required. It is only read again from the RTC after the
+ * persistent alarm queue or the weekly schedule armed the alarm.
+ */
+
 /**
   * @brief  get RTC subseconds.
   * @retval return the current subseconds from the RTC.
@@ -406,13 +1076,37 @@ void STM32RTC::getDate(uint8_t *weekDay, uint8_t *day, uint8_t *month, uint8_t *
   }
 }
 
+/**
+  * @brief  get RTC date and time.
+  * @note   Date and time are read coherently, even across midnight.
+  * @retval date and time, hours in 24 hours format
+  */
+STM32RTC::DateTime STM32RTC::getDateTime(void)
+{
+  uint32_t dateKey = RTC_GetRawDate();
+  uint8_t year, month, day;
+
+  syncTime();
+  if (RTC_GetRawDate() != dateKey) {
+    // Midnight elapsed between both reads
+    dateKey = RTC_GetRawDate();
+    syncTime();
+  }
+  // Date decoded from the raw date checked against the time read
+  RTC_DecodeRawDate(dateKey, &year, &month, &day);
+
+  // The week day is computed from the date by DateTime
+  return DateTime(year, month, day, toHours24(_hours, _hoursPeriod, _format == HOUR_12),
+                  _minutes, _seconds, _subSeconds);
+}
+
 /**
   * @brief  get RTC alarm subsecond.
   * @retval return the current alarm subsecond.
   */
 uint32_t STM32RTC::getAlarmSubSeconds(void)
 {
-  syncAlarmTime();
+  loadAlarmCache();
   return _alarmSubSeconds;
 }
 
@@ -422,7 +1116,7 @@ uint32_t STM32RTC::getAlarmSubSeconds(void)
   */
 uint8_t STM32RTC::getAlarmSeconds(void)
 {
-  syncAlarmTime();
+  loadAlarmCache();
   return _alarmSeconds;
 }
 
@@ -432,7 +1126,7 @@ uint8_t STM32RTC::getAlarmSeconds(void)
   */
 uint8_t STM32RTC::getAlarmMinutes(void)
 {
-  syncAlarmTime();
+  loadAlarmCache();
   return _alarmMinutes;
 }
 
@@ -444,7 +1138,7 @@ uint8_t STM32RTC::getAlarmMinutes(void)
   */
 uint8_t STM32RTC::getAlarmHours(AM_PM *period)
 {
-  syncAlarmTime();
+  loadAlarmCache();
   if (period != nullptr) {
     *period = _alarmPeriod;
   }
@@ -457,10 +1151,40 @@ uint8_t STM32RTC::getAlarmHours(AM_PM *period)
   */
 uint8_t STM32RTC::getAlarmDay(void)
 {
-  syncAlarmTime();
+  loadAlarmCache();
   return _alarmDay;
 }
 
+/**
+  * @brief  get RTC alarm week day.
+  * @retval return the current alarm week day (1-7, Monday first).
+  */
+uint8_t STM32RTC::getAlarmWeekDay(void)
+{
+  loadAlarmCache();
+  return _alarmWeekDay;
+}
+
+/**
+  * @brief  get RTC alarm configuration.
+  * @retval return the current alarm configuration.
+  */
+STM32RTC::Alarm_Config STM32RTC::getAlarm(void)
+{
+  Alarm_Config alarm;
+
+  loadAlarmCache();
+  alarm.day = _alarmDay;
+  alarm.weekDay = _alarmWeekDay;
+  alarm.hours = _alarmHours;
+  alarm.minutes = _alarmMinutes;
+  alarm.seconds = _alarmSeconds;
+  alarm.subSeconds = _alarmSubSeconds;
+  alarm.period = _alarmPeriod;
+  alarm.match = _alarmMatch;
+  return alarm;
+}
+
 /**
   * @brief  get RTC alarm month.
   * @NOTE   This function is kept for compatibility but the STM32 RTC
@@ -498,7 +1222,7 @@ void STM32RTC::setSubSeconds(uint32_t subSeconds)
   if (subSeconds < 1000) {
     _subSeconds = subSeconds;
   }
-  RTC_SetTime(_hours, _minutes, _seconds, _subSeconds, (_hoursPeriod == AM) ? HOUR_AM : HOUR_PM);
+  writeTime();
   _timeSet = true;
 }
 
@@ -513,7 +1237,7 @@ void STM32RTC::setSeconds(uint8_t seconds)
   if (seconds < 60) {
     _seconds = seconds;
   }
-  RTC_SetTime(_hours, _minutes, _seconds, _subSeconds, (_hoursPeriod == AM) ? HOUR_AM : HOUR_PM);
+  writeTime();
   _timeSet = true;
 }
 
@@ -528,7 +1252,7 @@ void STM32RTC::setMinutes(uint8_t minutes)
   if (minutes < 60) {
     _minutes = minutes;
   }
-  RTC_SetTime(_hours, _minutes, _seconds, _subSeconds, (_hoursPeriod == AM) ? HOUR_AM : HOUR_PM);
+  writeTime();
   _timeSet = true;
 }
 
@@ -547,7 +1271,7 @@ void STM32RTC::setHours(uint8_t hours, AM_PM period)
   if (_format == HOUR_12) {
     _hoursPeriod = period;
   }
-  RTC_SetTime(_hours, _minutes, _seconds, _subSeconds, (_hoursPeriod == AM) ? HOUR_AM : HOUR_PM);
+  writeTime();
   _timeSet = true;
 }
 
@@ -578,7 +1302,7 @@ void STM32RTC::setTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t
   if (_format == HOUR_12) {
     _hoursPeriod = period;
   }
-  RTC_SetTime(_hours, _minutes, _seconds, _subSeconds, (_hoursPeriod == AM) ? HOUR_AM : HOUR_PM);
+  writeTime();
   _timeSet = true;
 }
 
@@ -593,7 +1317,7 @@ void STM32RTC::setWeekDay(uint8_t weekDay)
   if ((weekDay >= 1) && (weekDay <= 7)) {
     _wday = weekDay;
   }
-  RTC_SetDate(_year, _month, _day, _wday);
+  writeDate();
   _timeSet = true;
 }
 
@@ -608,7 +1332,7 @@ void STM32RTC::setDay(uint8_t day)
   if ((day >= 1) && (day <= 31)) {
     _day = day;
   }
-  RTC_SetDate(_year, _month, _day, _wday);
+  writeDate();
   _timeSet = true;
 }
 
@@ -623,7 +1347,7 @@ void STM32RTC::setMonth(uint8_t month)
   if ((month >= 1) && (month <= 12)) {
     _month = month;
   }
-  RTC_SetDate(_year, _month, _day, _wday);
+  writeDate();
   _timeSet = true;
 }
 
@@ -638,7 +1362,7 @@ void STM32RTC::setYear(uint8_t year)
   if (year < 100) {
     _year = year;
   }
-  RTC_SetDate(_year, _month, _day, _wday);
+  writeDate();
   _timeSet = true;
 }
 
@@ -661,7 +1385,7 @@ void STM32RTC::setDate(uint8_t day, uint8_t month, uint8_t year)
   if (year < 100) {
     _year = year;
   }
-  RTC_SetDate(_year, _month, _day, _wday);
+  writeDate();
   _timeSet = true;
 }
 
@@ -688,7 +1412,7 @@ void STM32RTC::setDate(uint8_t weekDay, uint8_t day, uint8_t month, uint8_t year
   if (year < 100) {
     _year = year;
   }
-  RTC_SetDate(_year, _month, _day, _wday);
+  writeDate();
   _timeSet = true;
 }
 
@@ -699,6 +1423,7 @@ void STM32RTC::setDate(uint8_t weekDay, uint8_t day, uint8_t month, uint8_t year
   */
 void STM32RTC::setAlarmSubSeconds(uint32_t subSeconds)
 {
+  loadAlarmCache();
   if (subSeconds < 1000) {
     _alarmSubSeconds = subSeconds;
   }
@@ -711,6 +1436,7 @@ void STM32RTC::setAlarmSubSeconds(uint32_t subSeconds)
   */
 void STM32RTC::setAlarmSeconds(uint8_t seconds)
 {
+  loadAlarmCache();
   if (seconds < 60) {
     _alarmSeconds = seconds;
   }
@@ -723,6 +1449,7 @@ void STM32RTC::setAlarmSeconds(uint8_t seconds)
   */
 void STM32RTC::setAlarmMinutes(uint8_t minutes)
 {
+  loadAlarmCache();
   if (minutes < 60) {
     _alarmMinutes = minutes;
   }
@@ -736,6 +1463,7 @@ void STM32RTC::setAlarmMinutes(uint8_t minutes)
   */
 void STM32RTC::setAlarmHours(uint8_t hours, AM_PM period)
 {
+  loadAlarmCache();
   if (hours < 24) {
     _alarmHours = hours;
   }
@@ -768,11 +1496,26 @@ void STM32RTC::setAlarmTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uin
   */
 void STM32RTC::setAlarmDay(uint8_t day)
 {
+  loadAlarmCache();
   if ((day >= 1) && (day <= 31)) {
     _alarmDay = day;
   }
 }
 
+/**
+  * @brief  set RTC alarm week day.
+  * @note   Used when the alarm is enabled with MATCH_WDHHMMSS.
+  * @param  weekDay: 1-7 (Monday first)
+  * @retval none
+  */
+void STM32RTC::setAlarmWeekDay(uint8_t weekDay)
+{
+  loadAlarmCache();
+  if ((weekDay >= 1) && (weekDay <= 7)) {
+    _alarmWeekDay = weekDay;
+  }
+}
+
 /**
   * @brief  set RTC alarm month.
   * @NOTE   This function is kept for compatibility but the STM32 RTC
@@ -818,29 +1561,31 @@ void STM32RTC::setAlarmDate(uint8_t day, uint8_t month, uint8_t year)
   */
 uint32_t STM32RTC::getEpoch(uint32_t *subSeconds)
 {
-  struct tm tm;
+  uint32_t dateKey = RTC_GetRawDate();
 
-  syncDate();
   syncTime();
+  if (RTC_GetRawDate() != dateKey) {
+    // Midnight elapsed between both reads
+    dateKey = RTC_GetRawDate();
+    syncTime();
+  }
 
-  tm.tm_isdst = -1;
   /*
-   * mktime ignores the values supplied by the caller in the
-   * tm_wday and tm_yday fields
+   * The date part only changes once a day: compute the epoch of the
+   * current day midnight on date change only, from the date checked
+   * against the time read above.
    */
-  tm.tm_yday = 0;
-  tm.tm_wday = 0;
-  tm.tm_year = _year + EPOCH_TIME_YEAR_OFF;
-  tm.tm_mon = _month - 1;
-  tm.tm_mday = _day;
-  tm.tm_hour = _hours;
-  tm.tm_min = _minutes;
-  tm.tm_sec = _seconds;
+  if (dateKey != _epochDateKey) {
+    _epochDateBase = rawDateDays(dateKey) * SECONDS_PER_DAY;
+    _epochDateKey = dateKey;
+  }
+
   if (subSeconds != nullptr) {
     *subSeconds = _subSeconds;
   }
 
-  return mktime(&tm);
+  return _epochDateBase + (toHours24(_hours, _hoursPeriod, _format == HOUR_12) * 3600) +
+         (_minutes * 60) + _seconds;
 }
 
 /**
@@ -849,71 +1594,1419 @@ uint32_t STM32RTC::getEpoch(uint32_t *subSeconds)
   */
 uint32_t STM32RTC::getY2kEpoch(void)
 {
-  return (getEpoch() - EPOCH_TIME_OFF);
+  return getEpoch<Y2k_Epoch>();
 }
 
 /**
-  * @brief  set RTC alarm from epoch time
-  * @param  epoch time in seconds
+  * @brief  get a monotonic time, not affected by the calendar settings
+  * @note   It is the epoch time minus the sum of all the calendar steps done
+  *         by the library setters. The sum is kept in the backup register
+  *         RTC_BKP_MONOTONIC_OFFSET (if defined) to survive a reset.
+  * @param  subSeconds: optional pointer to where to store subseconds of the
+  *         time in ms
+  * @retval monotonic time in seconds
+  */
+uint32_t STM32RTC::getMonotonic(uint32_t *subSeconds)
+{
+  return getEpoch(subSeconds) - _monotonicOffset;
+}
+
+/**
+  * @brief  record that the time has just been synchronized.
+  * @note   To call after setting the time from a reference. The
+  *         synchronization is kept in the backup registers RTC_BKP_SYNC_EPOCH
+  *         and RTC_BKP_SYNC_INFO (if defined) to survive a reset.
+  *         The offset corrected by this synchronization is the drift of the
+  *         RTC since the previous one, used to fit the aging model.
+  * @param  source: source of the time, SYNC_NONE to invalidate the time
+  * @param  accuracy: optional (default: 0) accuracy in ms of the source
+  * @param  offset: optional (default: RTC_SYNC_OFFSET_UNKNOWN) reference time
+  *         minus the RTC time before setting it, in ms
+  * @retval none
+  */
+void STM32RTC::setSyncSource(Sync_Source source, uint32_t accuracy, int32_t offset)
+{
+  if (accuracy > SYNC_ACCURACY_MAX) {
+    accuracy = SYNC_ACCURACY_MAX;
+  }
+  uint32_t now = getMonotonic();
+  if (source != SYNC_NONE) {
+    fitAging(now, accuracy, offset);
+  }
+  _syncMonotonic = now;
+  _syncInfo = (accuracy << 8) | source;
+#if defined(RTC_BKP_SYNC_EPOCH) && defined(RTC_BKP_SYNC_INFO)
+  RTC_SetBackupWord(RTC_BKP_SYNC_EPOCH, _syncMonotonic);
+  RTC_SetBackupWord(RTC_BKP_SYNC_INFO, _syncInfo);
+#endif /* RTC_BKP_SYNC_EPOCH && RTC_BKP_SYNC_INFO */
+  if (source != SYNC_NONE) {
+    applyCalibration();
+  }
+}
+
+/**
+  * @brief  get the source of the last time synchronization.
+  * @retval source, SYNC_NONE if the time has never been synchronized
+  */
+STM32RTC::Sync_Source STM32RTC::getSyncSource(void)
+{
+  return static_cast<Sync_Source>(_syncInfo & 0xFF);
+}
+
+/**
+  * @brief  get the epoch time of the last time synchronization.
+  * @retval epoch time in seconds, 0 if the time has never been synchronized
+  */
+uint32_t STM32RTC::getLastSyncEpoch(void)
+{
+  if (getSyncSource() == SYNC_NONE) {
+    return 0;
+  }
+  return _syncMonotonic + _monotonicOffset;
+}
+
+/**
+  * @brief  set the estimated drift of the RTC clock.
+  * @param  ppm: drift in ppm, 0 to estimate it from the clock source
+  * @retval none
+  */
+void STM32RTC::setDriftPpm(uint32_t ppm)
+{
+  _driftPpm = ppm;
+}
+
+/**
+  * @brief  get the estimated drift of the RTC clock.
+  * @retval drift in ppm set by setDriftPpm() or else the typical accuracy of
+  *         the clock source
+  */
+uint32_t STM32RTC::getDriftPpm(void)
+{
+  if (_driftPpm != 0) {
+    return _driftPpm;
+  }
+  switch (_clockSource) {
+    case LSE_CLOCK:
+      return LSE_DRIFT_PPM;
+    case HSE_CLOCK:
+      return HSE_DRIFT_PPM;
+    case LSI_CLOCK:
+    default:
+      return LSI_DRIFT_PPM;
+  }
+}
+
+/**
+  * @brief  get the uncertainty bound of the current time.
+  * @note   Accuracy of the last synchronization plus the drift accumulated
+  *         since then.
+  * @retval uncertainty in ms, UINT32_MAX if the time has never been synchronized
+  */
+uint32_t STM32RTC::getTimeUncertainty(void)
+{
+  if (getSyncSource() == SYNC_NONE) {
+    return UINT32_MAX;
+  }
+  uint32_t elapsed = getMonotonic() - _syncMonotonic;
+  uint64_t uncertainty = (_syncInfo >> 8) + (((uint64_t)elapsed * getDriftPpm()) / 1000);
+  return (uncertainty > UINT32_MAX) ? UINT32_MAX : (uint32_t)uncertainty;
+}
+
+/*
+ * Calibration Functions
+ */
+
+/**
+  * @brief  set the static frequency correction of the RTC clock.
+  * @note   The correction applied is the sum of this one, of the
+  *         temperature compensation and of the aging compensation, with a
+  *         resolution of 0.954 ppm.
+  * @param  ppb: correction in ppb, positive to speed the RTC up
+  * @retval none
+  */
+void STM32RTC::setCalibration(int32_t ppb)
+{
+  _calibrationOffset = ppb;
+  applyCalibration();
+}
+
+/**
+  * @brief  get the frequency correction applied to the RTC clock.
+  * @retval correction in ppb, positive when the RTC is sped up
+  */
+int32_t STM32RTC::getCalibration(void)
+{
+  return _calibration;
+}
+
+/**
+  * @brief  enable the temperature compensation of the crystal.
+  * @note   Nothing is done in the background: updateTemperatureCompensation()
+  *         has to be called regularly, for example from loop() or after each
+  *         wake up, and only reads the temperature once per period.
+  * @param  model: parabola or table of the crystal frequency correction
+  * @param  source: callback returning the temperature in 0.01 °C
+  * @param  data: optional (default: nullptr) data passed to source
+  * @param  period: optional (default: 60) minimum time in seconds between
+  *         two temperature reads
+  * @retval none
+  */
+void STM32RTC::enableTemperatureCompensation(const Temperature_Model &model, temperatureFuncPtr source,
+                                             void *data, uint32_t period)
+{
+  _temperatureModel = model;
+  _temperatureSourceData = data;
+  _temperaturePeriod = period;
+  _temperatureSource = source;
+  // First update on the next call
+  _temperatureUpdate = getMonotonic();
+}
+
+/**
+  * @brief  disable the temperature compensation and remove its correction.
+  * @retval none
+  */
+void STM32RTC::disableTemperatureCompensation(void)
+{
+  _temperatureSource = nullptr;
+  _temperatureCorrection = 0;
+  applyCalibration();
+}
+
+/**
+  * @brief  update the temperature compensation if its period elapsed.
+  * @retval true if the calibration of the RTC has been changed
+  */
+bool STM32RTC::updateTemperatureCompensation(void)
+{
+  uint32_t now = getMonotonic();
+
+  if ((_temperatureSource == nullptr) || ((int32_t)(now - _temperatureUpdate) < 0)) {
+    return false;
+  }
+  _temperatureUpdate = now + _temperaturePeriod;
+  _temperatureCorrection = temperatureCorrection(_temperatureSource(_temperatureSourceData));
+  return applyCalibration();
+}
+
+/**
+  * @brief  get the current correction of the temperature compensation.
+  * @retval correction in ppb
+  */
+int32_t STM32RTC::getTemperatureCorrection(void)
+{
+  return _temperatureCorrection;
+}
+
+/**
+  * @brief  set the aging rate of the crystal.
+  * @note   The rate is otherwise fitted from the drift observed between two
+  *         synchronizations (see setSyncSource()). It is kept with the aging
+  *         correction in the backup register RTC_BKP_AGING (if defined).
+  *         Folded into the calibration on its next update.
+  * @param  ppbPerYear: frequency correction to add per year
+  * @param  fitted: optional (default: true) false to restart the fit: the
+  *         aging correction is cleared and the next drift observation sets
+  *         it before the rate is fitted again
+  * @retval none
+  */
+void STM32RTC::setAgingRate(int32_t ppbPerYear, bool fitted)
+{
+  uint32_t now = getMonotonic();
+  int64_t elapsed = (int32_t)(now - _syncMonotonic);
+  int32_t correction = fitted ? agingCorrection(now) : 0;
+
+  // Keep the current correction, extrapolated from the last synchronization
+  _agingRate = ppbPerYear;
+  _agingBase = correction - (int32_t)((elapsed * ppbPerYear) / SECONDS_PER_YEAR);
+  _agingFitted = fitted;
+  storeAging();
+}
+
+/**
+  * @brief  get the aging rate of the crystal.
+  * @retval frequency correction added per year, in ppb
+  */
+int32_t STM32RTC::getAgingRate(void)
+{
+  return _agingRate;
+}
+
+/**
+  * @brief  get the current correction of the aging compensation.
+  * @retval correction in ppb
+  */
+int32_t STM32RTC::getAgingCorrection(void)
+{
+  return agingCorrection(getMonotonic());
+}
+
+/**
+  * @brief  get the aging correction at a monotonic time: the correction fitted
+  *         at the last synchronization extrapolated with the aging rate.
+  * @param  now: monotonic time in seconds
+  * @retval correction in ppb
+  */
+int32_t STM32RTC::agingCorrection(uint32_t now)
+{
+  int64_t elapsed = (int32_t)(now - _syncMonotonic);
+  return _agingBase + (int32_t)((elapsed * _agingRate) / SECONDS_PER_YEAR);
+}
+
+/**
+  * @brief  fit the aging model with the drift observed since the previous
+  *         synchronization, then restart the extrapolation from now.
+  * @note   The drift is the offset corrected by the synchronization. The
+  *         calendar is set to whole seconds, so the interval has to be long
+  *         enough for the error of the observation to be below
+  *         AGING_MAX_ERROR_PPB, and an observation above
+  *         AGING_MAX_RESIDUAL_PPB is not a drift of the crystal.
+  * @param  now: monotonic time of the synchronization in seconds
+  * @param  accuracy: accuracy in ms of the synchronization
+  * @param  offset: offset in ms corrected by the synchronization,
+  *         RTC_SYNC_OFFSET_UNKNOWN if not known
+  * @retval none
+  */
+void STM32RTC::fitAging(uint32_t now, uint32_t accuracy, int32_t offset)
+{
+  int32_t correction = agingCorrection(now);
+  uint32_t elapsed = now - _syncMonotonic;
+  // Both synchronizations accuracies plus the setting resolution, in ms
+  uint64_t error = (uint64_t)accuracy + (_syncInfo >> 8) + 1000;
+
+  if ((offset != RTC_SYNC_OFFSET_UNKNOWN) && (getSyncSource() != SYNC_NONE) && (elapsed > 0) &&
+      ((error * 1000000) <= ((uint64_t)elapsed * AGING_MAX_ERROR_PPB))) {
+    // Mean frequency error left by the calibration over the interval
+    int64_t residual = ((int64_t)offset * 1000000) / elapsed;
+    uint64_t drift = (uint64_t)((offset < 0) ? -(int64_t)offset : offset);
+    if ((residual >= -AGING_MAX_RESIDUAL_PPB) && (residual <= AGING_MAX_RESIDUAL_PPB)) {
+      if (_agingFitted && (drift >= error)) {
+        // A linear aging leaves a mean error of half its drift over the interval
+        int64_t rate = (residual * 2 * SECONDS_PER_YEAR) / elapsed;
+        _agingRate += (int32_t)(rate / 4);
+      }
+      correction += (int32_t)residual;
+      _agingFitted = true;
+    }
+  }
+  _agingBase = correction;
+  storeAging();
+}
+
+/**
+  * @brief  save the aging model to the backup register RTC_BKP_AGING.
+  * @retval none
+  */
+void STM32RTC::storeAging(void)
+{
+  if (_agingRate > AGING_RATE_MAX) {
+    _agingRate = AGING_RATE_MAX;
+  } else if (_agingRate < -AGING_RATE_MAX) {
+    _agingRate = -AGING_RATE_MAX;
+  }
+  if (_agingBase > AGING_BASE_MAX) {
+    _agingBase = AGING_BASE_MAX;
+  } else if (_agingBase < -AGING_BASE_MAX) {
+    _agingBase = -AGING_BASE_MAX;
+  }
+#if defined(RTC_BKP_AGING)
+  int16_t base = (int16_t)((_agingBase + ((_agingBase < 0) ? -5 : 5)) / 10);
+  RTC_SetBackupWord(RTC_BKP_AGING, ((uint32_t)(uint16_t)base << 16) |
+                    (_agingFitted ? AGING_FITTED : 0) | ((uint32_t)_agingRate & AGING_RATE_MASK));
+#endif /* RTC_BKP_AGING */
+}
+
+/**
+  * @brief  get the crystal frequency correction at a temperature.
+  * @param  temperature: temperature in 0.01 °C
+  * @retval correction in ppb, interpolated from the table if any
+  */
+int32_t STM32RTC::temperatureCorrection(int32_t temperature)
+{
+  const Temperature_Point *table = _temperatureModel.table;
+  uint8_t size = _temperatureModel.tableSize;
+
+  if ((table == nullptr) || (size == 0)) {
+    // A tuning fork crystal slows down on both sides of its turnover
+    int64_t delta = temperature - _temperatureModel.turnover;
+    return (int32_t)((delta * delta * _temperatureModel.coefficient) / 10000);
+  }
+  if (temperature <= table[0].temperature) {
+    return table[0].correction;
+  }
+  for (uint8_t i = 1; i < size; i++) {
+    if (temperature <= table[i].temperature) {
+      int32_t span = table[i].temperature - table[i - 1].temperature;
+      int64_t step = (int64_t)(table[i].correction - table[i - 1].correction) *
+                     (temperature - table[i - 1].temperature);
+      return table[i - 1].correction + (int32_t)(step / span);
+    }
+  }
+  return table[size - 1].correction;
+}
+
+/**
+  * @brief  apply the sum of the corrections to the RTC, if it changes the
+  *         calibration by at least one step.
+  * @retval true if the calibration of the RTC has been changed
+  */
+bool STM32RTC::applyCalibration(void)
+{
+  int32_t ppb = _calibrationOffset + _temperatureCorrection + agingCorrection(getMonotonic()) +
+                _ppsCorrection;
+  int32_t delta = ppb - _calibration;
+
+  if ((delta < CALIBRATION_HALF_STEP_PPB) && (delta > -CALIBRATION_HALF_STEP_PPB)) {
+    return false;
+  }
+  int32_t applied = RTC_SetCalibration(ppb);
+  if (applied == _calibration) {
+    // Out of range or not available
+    return false;
+  }
+  _calibration = applied;
+  return true;
+}
+
+/**
+  * @brief  get the epoch time of the next alarm occurrence
+  * @note   Computed from the alarm configuration and the match mask,
+  *         skipping the months without the alarm day.
+  *         The subseconds are ignored.
+  * @retval epoch time in seconds of the next occurrence strictly after the
+  *         current time, 0 if the alarm is disabled
+  */
+uint32_t STM32RTC::getNextAlarmEpoch(void)
+{
+  if (!RTC_IsAlarmSet()) {
+    return 0;
+  }
+  loadAlarmCache();
+  return nextAlarmEpoch(getEpoch());
+}
+
+/**
+  * @brief  set RTC alarm from epoch time
+  * @param  epoch time in seconds
   * @param  Alarm_Match match enum
   * @param  subSeconds subSeconds in ms
   */
-void STM32RTC::setAlarmEpoch(uint32_t ts, Alarm_Match match, uint32_t subSeconds)
+void STM32RTC::setAlarmEpoch(uint32_t ts, Alarm_Match match, uint32_t subSeconds)
+{
+  if (ts < EPOCH_TIME_OFF) {
+    ts = EPOCH_TIME_OFF;
+  }
+
+  time_t t = ts;
+  struct tm *tmp = gmtime(&t);
+
+  AM_PM period;
+  uint8_t hours = fromHours24(tmp->tm_hour, &period, _format == HOUR_12);
+
+  setAlarmDay(tmp->tm_mday);
+  setAlarmHours(hours, period);
+  setAlarmMinutes(tmp->tm_min);
+  setAlarmSeconds(tmp->tm_sec);
+  setAlarmSubSeconds(subSeconds);
+  enableAlarm(match);
+}
+
+/**
+  * @brief  set RTC time from epoch time
+  * @param  epoch time in seconds
+  * @param  subSeconds subSeconds in ms
+  */
+void STM32RTC::setEpoch(uint32_t ts, uint32_t subSeconds)
+{
+  if (ts < EPOCH_TIME_OFF) {
+    ts = EPOCH_TIME_OFF;
+  }
+
+  time_t t = ts;
+  struct tm *tmp = gmtime(&t);
+
+  _year = tmp->tm_year - EPOCH_TIME_YEAR_OFF;
+  _month = tmp->tm_mon + 1;
+  _day = tmp->tm_mday;
+  if (tmp->tm_wday == 0) {
+    _wday = RTC_WEEKDAY_SUNDAY;
+  } else {
+    _wday = tmp->tm_wday;
+  }
+  _hours = fromHours24(tmp->tm_hour, &_hoursPeriod, _format == HOUR_12);
+  _minutes = tmp->tm_min;
+  _seconds = tmp->tm_sec;
+  _subSeconds = subSeconds;
+
+  writeCalendar(true, true);
+  _timeSet = true;
+}
+
+/**
+  * @brief  set RTC time from epoch time since 1st January 2000, 00:00:00
+  * @param  epoch time in seconds
+  */
+void STM32RTC::setY2kEpoch(uint32_t ts)
+{
+  setEpoch<Y2k_Epoch>(ts);
+}
+
+/*
+ * PPS discipline Functions
+ */
+
+/**
+  * @brief  enable the discipline of the RTC by a pulse per second signal.
+  * @note   The phase of each edge is measured against the subseconds. The
+  *         calendar is shifted by whole RTC ticks for the phase and the
+  *         calibration corrects the frequency, fitted over a window of up to
+  *         PPS_WINDOW_MAX edges. The phase resolution is one RTC tick: lower
+  *         the asynchronous prescaler for finer ticks.
+  *         Nothing is done in the background: updatePpsDiscipline() has to
+  *         be called at least once per second. The seconds are not set: use
+  *         setEpoch() with the time message of the source.
+  * @param  input: optional (default: PPS_TIMESTAMP_RISING) edge of the time
+  *         stamp input (RTC_TS pin), or PPS_INTERRUPT to call ppsEdge() from
+  *         a pin interrupt
+  * @retval true if the discipline is enabled
+  */
+bool STM32RTC::enablePpsDiscipline(Pps_Input input)
+{
+#if defined(RTC_SYNCHRO_SHIFT)
+  disablePpsDiscipline();
+  if (input != PPS_INTERRUPT) {
+#if defined(RTC_TIMESTAMP_IT)
+    attachTimeStampCallback(ppsDispatch, nullptr);
+    if (!RTC_EnableTimeStamp(input == PPS_TIMESTAMP_FALLING)) {
+      detachTimeStampCallback();
+      return false;
+    }
+#else
+    return false;
+#endif /* RTC_TIMESTAMP_IT */
+  }
+  _ppsInput = input;
+  _ppsTicksPerSecond = RTC_GetTicksPerSecond();
+  _ppsProcessed = _ppsCount;
+  _ppsLastEdge = millis();
+  _ppsWindow = PPS_WINDOW_MIN;
+  _ppsState = PPS_ACQUIRING;
+  return true;
+#else
+  UNUSED(input);
+  return false;
+#endif /* RTC_SYNCHRO_SHIFT */
+}
+
+/**
+  * @brief  disable the PPS discipline and remove its frequency correction.
+  * @retval none
+  */
+void STM32RTC::disablePpsDiscipline(void)
+{
+#if defined(RTC_TIMESTAMP_IT)
+  if ((_ppsState != PPS_OFF) && (_ppsInput != PPS_INTERRUPT)) {
+    RTC_DisableTimeStamp();
+    detachTimeStampCallback();
+  }
+#endif /* RTC_TIMESTAMP_IT */
+  _ppsState = PPS_OFF;
+  _ppsCorrection = 0;
+  applyCalibration();
+}
+
+/**
+  * @brief  capture a PPS edge, to call from the pin interrupt when the
+  *         discipline is enabled with PPS_INTERRUPT.
+  * @note   The interrupt latency adds to the phase measured.
+  * @retval none
+  */
+void STM32RTC::ppsEdge(void)
+{
+  rawTime_t raw;
+  uint32_t seconds;
+  int32_t ticks;
+
+  RTC_GetRawTime(&raw);
+  RTC_DecodeRawTime(&raw, &seconds, &ticks);
+  _ppsTicks = ticks;
+  _ppsCount = _ppsCount + 1;
+}
+
+/**
+  * @brief  run the PPS discipline on the last edge captured.
+  * @note   Without edge for PPS_HOLDOVER_MS, the discipline enters holdover:
+  *         the frequency correction is kept until the edges come back.
+  * @retval true if the calendar or the calibration of the RTC has been changed
+  */
+bool STM32RTC::updatePpsDiscipline(void)
+{
+#if defined(RTC_SYNCHRO_SHIFT)
+  uint32_t count;
+  int32_t ticks;
+
+  if (_ppsState == PPS_OFF) {
+    return false;
+  }
+  // The interrupt writes the phase before the count
+  do {
+    count = _ppsCount;
+    ticks = _ppsTicks;
+  } while (count != _ppsCount);
+
+  if (count == _ppsProcessed) {
+    if (((_ppsState == PPS_TRACKING) || (_ppsState == PPS_LOCKED)) &&
+        ((millis() - _ppsLastEdge) > PPS_HOLDOVER_MS)) {
+      _ppsState = PPS_HOLDOVER;
+    }
+    return false;
+  }
+  _ppsProcessed = count;
+  _ppsLastEdge = millis();
+  return ppsMeasure(count, ticks);
+#else
+  return false;
+#endif /* RTC_SYNCHRO_SHIFT */
+}
+
+/**
+  * @brief  get the state of the PPS discipline.
+  * @retval PPS_OFF, PPS_ACQUIRING, PPS_TRACKING, PPS_LOCKED or PPS_HOLDOVER
+  */
+STM32RTC::Pps_State STM32RTC::getPpsState(void)
+{
+  return _ppsState;
+}
+
+/**
+  * @brief  get the state and the residual errors of the PPS discipline.
+  * @retval status: state, last phase error, last frequency error (fitted over
+  *         the last window), correction applied and number of edges
+  */
+STM32RTC::Pps_Status STM32RTC::getPpsStatus(void)
+{
+  Pps_Status status = {_ppsState, _ppsPhase, _ppsFrequency, _ppsCorrection, _ppsCount};
+  return status;
+}
+
+#if defined(RTC_SYNCHRO_SHIFT)
+/**
+  * @brief  process a PPS edge: step the phase while acquiring, else shift
+  *         the phase back within one tick (PLL) and fit the frequency over
+  *         the window (FLL).
+  * @note   The shifts are added back to the phase fitted, and the frequency
+  *         correction is the mean calibration applied over the window minus
+  *         the frequency error fitted: neither the shifts nor the other
+  *         corrections bias it.
+  * @param  count: edge count
+  * @param  ticks: RTC ticks elapsed in the second at the edge
+  * @retval true if the calendar or the calibration of the RTC has been changed
+  */
+bool STM32RTC::ppsMeasure(uint32_t count, int32_t ticks)
+{
+  int32_t period = (int32_t)_ppsTicksPerSecond;
+  int32_t tick = 1000000000 / period;
+  // Phase in ticks in [-1/2, 1/2[ second, positive when the RTC is ahead
+  int32_t phase = ((ticks % period) + period) % period;
+  if (phase >= (period / 2)) {
+    phase -= period;
+  }
+  // Middle of the tick: the edge is in [phase, phase + 1[ ticks
+  _ppsPhase = (phase * tick) + (tick / 2);
+
+  if ((phase > (period / 16)) || (phase < -(period / 16))) {
+    // Phase jump
+    _ppsState = PPS_ACQUIRING;
+  }
+  if ((_ppsState != PPS_TRACKING) && (_ppsState != PPS_LOCKED)) {
+    bool stepped = false;
+    if ((phase > 0) || (phase < -1)) {
+      stepped = RTC_ShiftTicks(-phase);
+      _ppsState = PPS_ACQUIRING;
+      _ppsWindow = PPS_WINDOW_MIN;
+    } else {
+      _ppsState = PPS_TRACKING;
+    }
+    ppsRestartWindow(count);
+    return stepped;
+  }
+
+  int64_t x = count - _ppsWindowStart;
+  int64_t y = (int64_t)(phase + _ppsShifted) * tick;
+  _ppsSamples++;
+  _ppsSumX += x;
+  _ppsSumY += y;
+  _ppsSumXX += x * x;
+  _ppsSumXY += x * y;
+  _ppsSumCalibration += _calibration;
+
+  // Keep the edge in the ticks -1 or 0
+  int32_t shift = (phase > 0) ? phase : ((phase < -1) ? (phase + 1) : 0);
+  bool changed = (shift != 0) && RTC_ShiftTicks(-shift);
+  if (changed) {
+    _ppsShifted += shift;
+  }
+  if ((x < (int64_t)_ppsWindow) || (_ppsSamples < 2)) {
+    return changed;
+  }
+
+  // Linear fit: the slope in ns/s is the frequency error in ppb
+  int64_t n = _ppsSamples;
+  int64_t slope = ((n * _ppsSumXY) - (_ppsSumX * _ppsSumY)) / ((n * _ppsSumXX) - (_ppsSumX * _ppsSumX));
+  int32_t others = _calibrationOffset + _temperatureCorrection + agingCorrection(getMonotonic());
+  _ppsFrequency = (int32_t)slope;
+  _ppsCorrection = (int32_t)(_ppsSumCalibration / n) - _ppsFrequency - others;
+
+  if ((_ppsFrequency <= PPS_LOCK_PPB) && (_ppsFrequency >= -PPS_LOCK_PPB)) {
+    _ppsState = PPS_LOCKED;
+    if (_ppsWindow < PPS_WINDOW_MAX) {
+      _ppsWindow *= 2;
+    }
+  } else {
+    _ppsState = PPS_TRACKING;
+    if (_ppsWindow > PPS_WINDOW_MIN) {
+      _ppsWindow /= 2;
+    }
+  }
+  ppsRestartWindow(count);
+  return applyCalibration() || changed;
+}
+
+/**
+  * @brief  restart the fit of the phase from an edge.
+  * @param  count: edge count at the start of the window
+  * @retval none
+  */
+void STM32RTC::ppsRestartWindow(uint32_t count)
+{
+  _ppsWindowStart = count;
+  _ppsShifted = 0;
+  _ppsSamples = 0;
+  _ppsSumX = 0;
+  _ppsSumY = 0;
+  _ppsSumXX = 0;
+  _ppsSumXY = 0;
+  _ppsSumCalibration = 0;
+}
+#endif /* RTC_SYNCHRO_SHIFT */
+
+#if defined(RTC_TIMESTAMP_IT)
+/**
+  * @brief  RTC time stamp dispatcher for the PPS discipline.
+  * @param  data: not used
+  * @retval none
+  */
+void STM32RTC::ppsDispatch(void *data)
+{
+  UNUSED(data);
+  STM32RTC &rtc = getInstance();
+
+  rtc._ppsTicks = RTC_GetTimeStampTicks(nullptr);
+  rtc._ppsCount = rtc._ppsCount + 1;
+}
+#endif /* RTC_TIMESTAMP_IT */
+
+/*
+ * Stopwatch Functions
+ */
+
+/**
+  * @brief  start the stopwatch: take a snapshot of the RTC registers.
+  * @retval none
+  */
+void STM32RTC::Stopwatch::start(void)
+{
+  RTC_GetRawTime(&_start);
+}
+
+/**
+  * @brief  get the time elapsed since start() in RTC ticks.
+  * @note   Only one register snapshot is taken. The date is only decoded
+  *         when it changed since start(). Subseconds shift operations are
+  *         taken into account, a calendar setting is not.
+  * @retval elapsed ticks, see ticksPerSecond()
+  */
+int64_t STM32RTC::Stopwatch::elapsedTicks(void) const
+{
+  rawTime_t now;
+  uint32_t startSeconds, nowSeconds;
+  int32_t startTicks, nowTicks;
+
+  RTC_GetRawTime(&now);
+  RTC_DecodeRawTime(&_start, &startSeconds, &startTicks);
+  RTC_DecodeRawTime(&now, &nowSeconds, &nowTicks);
+
+  int64_t seconds = (int64_t)nowSeconds - startSeconds;
+  if (now.date != _start.date) {
+    seconds += ((int64_t)rawDateDays(now.date) - rawDateDays(_start.date)) * SECONDS_PER_DAY;
+  }
+  return (seconds * ticksPerSecond()) + nowTicks - startTicks;
+}
+
+/**
+  * @brief  get the time elapsed since start() in us.
+  * @retval elapsed time in us, with the RTC ticks resolution
+  */
+int64_t STM32RTC::Stopwatch::elapsedMicros(void) const
+{
+  return (elapsedTicks() * 1000000) / ticksPerSecond();
+}
+
+/**
+  * @brief  get the time elapsed since start() in ms.
+  * @retval elapsed time in ms
+  */
+int64_t STM32RTC::Stopwatch::elapsedMillis(void) const
+{
+  return (elapsedTicks() * 1000) / ticksPerSecond();
+}
+
+/**
+  * @brief  get the stopwatch resolution.
+  * @retval number of RTC ticks in one second
+  */
+uint32_t STM32RTC::Stopwatch::ticksPerSecond(void)
+{
+  return RTC_GetTicksPerSecond();
+}
+
+/*
+ * Synchronized actions Functions
+ */
+
+/**
+  * @brief  wait for the beginning of the next second.
+  * @note   The RTC alarm B matches the start of the second: the wait is done
+  *         in sleep mode and does not poll the subseconds.
+  *         Not available if the alarm B is used by scheduleAt().
+  * @param  jitter: optional (default: nullptr) delay in us between the second
+  *         edge and its detection
+  * @retval epoch time in seconds of the new second, 0 if not available
+  */
+uint32_t STM32RTC::waitForSecondEdge(uint32_t *jitter)
+{
+#if defined(RTC_SYNC_ALARM)
+  if (_syncCallback != nullptr) {
+    return 0;
+  }
+  _syncEdge = false;
+  _syncWaiting = true;
+  _syncTargetTicks = 0;
+  attachAlarmBCallback(syncDispatch, nullptr);
+  // All fields masked, subseconds matching the start of the second. The
+  // hours must still be valid for the hour format or the alarm is not set.
+  RTC_StartAlarmB(1, (RTC_GetHourFormat() == HOUR_FORMAT_12) ? 12 : 0, 0, 0, 0, HOUR_AM, OFF_MSK);
+
+  uint32_t start = millis();
+  while (!_syncEdge && ((millis() - start) < 1100)) {
+    __WFI();
+  }
+  _syncWaiting = false;
+  RTC_StopAlarmB();
+  detachAlarmBCallback();
+
+  if (!_syncEdge) {
+    return 0;
+  }
+  if (jitter != nullptr) {
+    *jitter = _syncJitter;
+  }
+  return _syncStamp.epoch;
+#else
+  UNUSED(jitter);
+  return 0;
+#endif /* RTC_SYNC_ALARM */
+}
+
+/**
+  * @brief  schedule a callback at a given epoch and subseconds.
+  * @note   The RTC alarm B matches the date, time and subseconds so the
+  *         callback is called from the alarm interrupt, aligned on the RTC
+  *         ticks. The callback receives the time stamp of the interrupt.
+  *         Only one action can be scheduled at a time.
+  *         The alarm matches when the RTC enters the target tick: a target
+  *         reached before the alarm is armed is rejected, else it would
+  *         only match a month later.
+  * @param  ts: epoch time in seconds, at most 28 days ahead
+  * @param  subSeconds: offset in ms in the second (0-999)
+  * @param  callback: pointer to the callback
+  * @param  data: optional (default: nullptr) user data passed to the callback
+  * @retval true if the action has been scheduled
+  */
+bool STM32RTC::scheduleAt(uint32_t ts, uint32_t subSeconds, timeStampFuncPtr callback, void *data)
 {
-  if (ts < EPOCH_TIME_OFF) {
-    ts = EPOCH_TIME_OFF;
+#if defined(RTC_SYNC_ALARM)
+  int32_t nowTicks;
+  uint32_t now = rawEpochTicks(&nowTicks);
+  uint32_t ticksPerSecond;
+
+  RTC_GetSubSecondTicks(&ticksPerSecond);
+  int32_t targetTicks = (subSeconds * ticksPerSecond) / 1000;
+  if ((callback == nullptr) || (subSeconds > 999) || _syncWaiting || (ts < now) ||
+      ((ts == now) && (targetTicks <= nowTicks)) || ((ts - now) > (28 * SECONDS_PER_DAY))) {
+    return false;
   }
 
   time_t t = ts;
   struct tm *tmp = gmtime(&t);
+  AM_PM period;
+  uint8_t hours = fromHours24(tmp->tm_hour, &period, RTC_GetHourFormat() == HOUR_FORMAT_12);
+
+  _syncTargetTicks = targetTicks;
+  _syncCallback = callback;
+  _syncCallbackData = data;
+  attachAlarmBCallback(syncDispatch, nullptr);
+  RTC_StartAlarmB(tmp->tm_mday, hours, tmp->tm_min, tmp->tm_sec, subSeconds,
+                  (period == AM) ? HOUR_AM : HOUR_PM, MATCH_DHHMMSS);
+
+  // Target reached while the alarm was armed and not matched
+  now = rawEpochTicks(&nowTicks);
+  if (((now > ts) || ((now == ts) && (nowTicks >= targetTicks))) && (_syncCallback != nullptr)) {
+    cancelScheduleAt();
+    return false;
+  }
+  return true;
+#else
+  UNUSED(ts);
+  UNUSED(subSeconds);
+  UNUSED(callback);
+  UNUSED(data);
+  return false;
+#endif /* RTC_SYNC_ALARM */
+}
 
-  setAlarmDay(tmp->tm_mday);
-  setAlarmHours(tmp->tm_hour);
-  setAlarmMinutes(tmp->tm_min);
-  setAlarmSeconds(tmp->tm_sec);
-  setAlarmSubSeconds(subSeconds);
-  enableAlarm(match);
+/**
+  * @brief  cancel the action scheduled by scheduleAt().
+  * @retval none
+  */
+void STM32RTC::cancelScheduleAt(void)
+{
+#if defined(RTC_SYNC_ALARM)
+  if (_syncCallback != nullptr) {
+    RTC_StopAlarmB();
+    detachAlarmBCallback();
+    _syncCallback = nullptr;
+    _syncCallbackData = nullptr;
+  }
+#endif /* RTC_SYNC_ALARM */
 }
 
 /**
-  * @brief  set RTC time from epoch time
-  * @param  epoch time in seconds
-  * @param  subSeconds subSeconds in ms
+  * @brief  get the alignment jitter of the last synchronized action.
+  * @retval delay in us between the requested time and the interrupt entry
   */
-void STM32RTC::setEpoch(uint32_t ts, uint32_t subSeconds)
+uint32_t STM32RTC::getSyncJitter(void)
 {
-  if (ts < EPOCH_TIME_OFF) {
-    ts = EPOCH_TIME_OFF;
+  return _syncJitter;
+}
+
+#if defined(RTC_SYNC_ALARM)
+/**
+  * @brief  RTC alarm B dispatcher for the synchronized actions.
+  * @param  data: not used
+  * @retval none
+  */
+void STM32RTC::syncDispatch(void *data)
+{
+  UNUSED(data);
+  STM32RTC &rtc = getInstance();
+  uint32_t ticksPerSecond;
+  // Read the subseconds first to measure the interrupt latency
+  uint32_t ticks = RTC_GetSubSecondTicks(&ticksPerSecond);
+
+  rtc._syncStamp.epoch = rawEpoch(&rtc._syncStamp.subSeconds);
+  ticks = (ticks + ticksPerSecond - rtc._syncTargetTicks) % ticksPerSecond;
+  rtc._syncJitter = (uint32_t)(((uint64_t)ticks * 1000000) / ticksPerSecond);
+
+  // One shot
+  RTC_StopAlarmB();
+  if (rtc._syncWaiting) {
+    rtc._syncEdge = true;
+  } else if (rtc._syncCallback != nullptr) {
+    timeStampFuncPtr callback = rtc._syncCallback;
+    rtc._syncCallback = nullptr;
+    callback(&rtc._syncStamp, rtc._syncCallbackData);
   }
+}
+#endif /* RTC_SYNC_ALARM */
 
-  time_t t = ts;
-  struct tm *tmp = gmtime(&t);
+/*
+ * Persistent alarm queue Functions
+ */
 
-  _year = tmp->tm_year - EPOCH_TIME_YEAR_OFF;
-  _month = tmp->tm_mon + 1;
-  _day = tmp->tm_mday;
-  if (tmp->tm_wday == 0) {
-    _wday = RTC_WEEKDAY_SUNDAY;
+#if defined(RTC_BKP_ALARM_QUEUE)
+// Each entry is 2 words: target epoch (0 if free), then period << 8 | id
+#define QUEUE_TARGET_REG(i) (RTC_BKP_ALARM_QUEUE + ((i) * 2 * RTC_BKP_WORD_SIZE))
+#define QUEUE_INFO_REG(i)   (QUEUE_TARGET_REG(i) + RTC_BKP_WORD_SIZE)
+#define QUEUE_PERIOD_MAX    0xFFFFFF
+// The alarm matches the day of the month: farther targets need intermediate alarms
+#define QUEUE_ARM_MAX       (28 * SECONDS_PER_DAY)
+#endif /* RTC_BKP_ALARM_QUEUE */
+
+/**
+  * @brief  set an alarm of the persistent alarm queue.
+  * @note   The queue is stored in backup registers and keeps running after a
+  *         reset or a Standby: the application only has to attach the handlers.
+  *         The RTC alarm is always armed for the earliest entry.
+  * @param  id: alarm identifier. The entry with the same id is replaced.
+  * @param  ts: epoch time in seconds of the first occurrence
+  * @param  period: optional (default: 0) period in seconds (up to 16777215)
+  *         of the alarm, 0 for a single occurrence.
+  * @retval true if the alarm has been queued
+  */
+bool STM32RTC::setQueuedAlarm(uint8_t id, uint32_t ts, uint32_t period)
+{
+#if defined(RTC_BKP_ALARM_QUEUE)
+  int8_t index = -1;
+
+  if ((ts == 0) || (period > QUEUE_PERIOD_MAX)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < RTC_ALARM_QUEUE_SIZE; i++) {
+    if (RTC_GetBackupWord(QUEUE_TARGET_REG(i)) == 0) {
+      if (index == -1) {
+        index = i;
+      }
+    } else if ((RTC_GetBackupWord(QUEUE_INFO_REG(i)) & 0xFF) == id) {
+      index = i;
+      break;
+    }
+  }
+  if (index == -1) {
+    return false;
+  }
+  RTC_SetBackupWord(QUEUE_INFO_REG(index), (period << 8) | id);
+  RTC_SetBackupWord(QUEUE_TARGET_REG(index), ts);
+  processAlarmQueue();
+  return true;
+#else
+  UNUSED(id);
+  UNUSED(ts);
+  UNUSED(period);
+  return false;
+#endif /* RTC_BKP_ALARM_QUEUE */
+}
+
+/**
+  * @brief  remove an alarm from the persistent alarm queue.
+  * @param  id: alarm identifier
+  * @retval true if the alarm was queued
+  */
+bool STM32RTC::cancelQueuedAlarm(uint8_t id)
+{
+#if defined(RTC_BKP_ALARM_QUEUE)
+  for (uint8_t i = 0; i < RTC_ALARM_QUEUE_SIZE; i++) {
+    if ((RTC_GetBackupWord(QUEUE_TARGET_REG(i)) != 0) &&
+        ((RTC_GetBackupWord(QUEUE_INFO_REG(i)) & 0xFF) == id)) {
+      RTC_SetBackupWord(QUEUE_TARGET_REG(i), 0);
+      processAlarmQueue();
+      return true;
+    }
+  }
+#else
+  UNUSED(id);
+#endif /* RTC_BKP_ALARM_QUEUE */
+  return false;
+}
+
+/**
+  * @brief  attach the handler of a queued alarm.
+  * @note   If the alarm is already due (for example it expired during a
+  *         reset), the handler is called immediately.
+  * @param  id: alarm identifier
+  * @param  callback: pointer to the callback
+  * @param  data: optional (default: nullptr) user data passed to the callback
+  * @retval true if the handler has been attached
+  */
+bool STM32RTC::attachQueuedAlarmHandler(uint8_t id, voidFuncPtr callback, void *data)
+{
+  int8_t index = -1;
+
+  for (uint8_t i = 0; i < RTC_ALARM_QUEUE_SIZE; i++) {
+    if (_queueHandlers[i].callback == nullptr) {
+      if (index == -1) {
+        index = i;
+      }
+    } else if (_queueHandlers[i].id == id) {
+      index = i;
+      break;
+    }
+  }
+  if ((index == -1) || (callback == nullptr)) {
+    return false;
+  }
+  _queueHandlers[index].id = id;
+  _queueHandlers[index].data = data;
+  _queueHandlers[index].callback = callback;
+  processAlarmQueue();
+  return true;
+}
+
+/**
+  * @brief  detach the handler of a queued alarm.
+  * @param  id: alarm identifier
+  * @retval none
+  */
+void STM32RTC::detachQueuedAlarmHandler(uint8_t id)
+{
+  for (uint8_t i = 0; i < RTC_ALARM_QUEUE_SIZE; i++) {
+    if ((_queueHandlers[i].callback != nullptr) && (_queueHandlers[i].id == id)) {
+      _queueHandlers[i].callback = nullptr;
+    }
+  }
+}
+
+/**
+  * @brief  call the handlers of the due queued alarms, reschedule the periodic
+  *         ones and arm the RTC alarm for the earliest remaining entry.
+  * @note   A due alarm without handler is kept until its handler is attached.
+  *         An entry more than 28 days ahead can't be matched by the day of
+  *         the month only: the RTC alarm is then armed at the same time of day
+  *         28 days ahead at most, and armed again when this intermediate
+  *         alarm expires.
+  *         Called from the alarm interrupt: the calendar and alarm members
+  *         are not used. A call during the processing (from a handler or
+  *         from the interrupt) only requests another pass.
+  * @retval none
+  */
+void STM32RTC::processAlarmQueue(void)
+{
+#if defined(RTC_BKP_ALARM_QUEUE)
+  uint32_t now, next;
+  bool active;
+
+  if (_queueBusy) {
+    _queueRescan = true;
+    return;
+  }
+  _queueBusy = true;
+  do {
+    _queueRescan = false;
+    now = rawEpoch();
+    next = 0;
+    active = false;
+    for (uint8_t i = 0; i < RTC_ALARM_QUEUE_SIZE; i++) {
+      uint32_t target = RTC_GetBackupWord(QUEUE_TARGET_REG(i));
+      if (target == 0) {
+        continue;
+      }
+      active = true;
+      uint32_t info = RTC_GetBackupWord(QUEUE_INFO_REG(i));
+      if (target <= now) {
+        const Queued_Handler *handler = nullptr;
+        for (uint8_t j = 0; j < RTC_ALARM_QUEUE_SIZE; j++) {
+          if ((_queueHandlers[j].callback != nullptr) && (_queueHandlers[j].id == (info & 0xFF))) {
+            handler = &_queueHandlers[j];
+            break;
+          }
+        }
+        if (handler == nullptr) {
+          // Keep it pending until its handler is attached
+          continue;
+        }
+        // Update the entry before the call as the handler can modify the
+        // queue, then scan it again
+        uint32_t period = info >> 8;
+        if (period != 0) {
+          target += ((now - target) / period + 1) * period;
+        } else {
+          target = 0;
+        }
+        RTC_SetBackupWord(QUEUE_TARGET_REG(i), target);
+        _queueRescan = true;
+        handler->callback(handler->data);
+        continue;
+      }
+      if ((next == 0) || (target < next)) {
+        next = target;
+      }
+    }
+
+    if (!_queueRescan) {
+      bool wasActive = _queueActive;
+      _queueActive = active;
+      updateAlarmCallback();
+      if (next != 0) {
+        uint32_t armed = next;
+        if ((armed - now) > QUEUE_ARM_MAX) {
+          // Latest intermediate alarm at the same time of day
+          armed -= ((armed - now - QUEUE_ARM_MAX + SECONDS_PER_DAY - 1) / SECONDS_PER_DAY) * SECONDS_PER_DAY;
+        }
+        startAlarmEpoch(armed, MATCH_DHHMMSS);
+        if (rawEpoch() >= armed) {
+          // Elapsed while arming
+          _queueRescan = true;
+        }
+      } else if (active || wasActive) {
+        // Only pending alarms without handler or queue emptied
+        startAlarmEpoch(0, MATCH_OFF);
+      }
+    }
+  } while (_queueRescan);
+  _queueBusy = false;
+  if (_queueRescan) {
+    // Interrupted just before the end
+    processAlarmQueue();
+  }
+#endif /* RTC_BKP_ALARM_QUEUE */
+}
+
+/*
+ * Weekly schedule Functions
+ */
+
+/**
+  * @brief  add an entry to the weekly alarm schedule.
+  * @note   The schedule is applied by enableWeeklySchedule().
+  * @param  weekDays: Week_Day_Mask combination of the days of the entry
+  * @param  hours: 0-23 (24 hours format)
+  * @param  minutes: 0-59
+  * @param  seconds: 0-59 (optional)
+  * @retval true if the entry has been added
+  */
+bool STM32RTC::addWeeklyAlarm(uint8_t weekDays, uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+  if ((_weeklyCount >= RTC_WEEKLY_SCHEDULE_SIZE) || ((weekDays & EVERYDAY_MSK) == 0) ||
+      (hours > 23) || (minutes > 59) || (seconds > 59)) {
+    return false;
+  }
+  _weeklySchedule[_weeklyCount].weekDays = weekDays & EVERYDAY_MSK;
+  _weeklySchedule[_weeklyCount].hours = hours;
+  _weeklySchedule[_weeklyCount].minutes = minutes;
+  _weeklySchedule[_weeklyCount].seconds = seconds;
+  _weeklyCount++;
+  if (_weeklyEnabled) {
+    armWeeklySchedule();
+  }
+  return true;
+}
+
+/**
+  * @brief  remove all entries of the weekly alarm schedule.
+  * @retval none
+  */
+void STM32RTC::clearWeeklySchedule(void)
+{
+  _weeklyCount = 0;
+  if (_weeklyEnabled) {
+    armWeeklySchedule();
+  }
+}
+
+/**
+  * @brief  enable the weekly alarm schedule.
+  * @note   The schedule uses the RTC alarm: the alarm callback set with
+  *         attachInterrupt() is called for each entry occurrence.
+  * @retval none
+  */
+void STM32RTC::enableWeeklySchedule(void)
+{
+  _weeklyEnabled = true;
+  updateAlarmCallback();
+  armWeeklySchedule();
+}
+
+/**
+  * @brief  disable the weekly alarm schedule and the RTC alarm.
+  * @retval none
+  */
+void STM32RTC::disableWeeklySchedule(void)
+{
+  _weeklyEnabled = false;
+  _weeklyRearm = false;
+  updateAlarmCallback();
+  disableAlarm();
+}
+
+/**
+  * @brief  program the RTC alarm for the weekly schedule.
+  * @note   When all entries share the same time, a single programming is
+  *         enough if they cover every day (daily match) or a single day
+  *         (week day match). Else the alarm is programmed for the next
+  *         occurrence and reprogrammed each time it expires.
+  * @retval none
+  */
+void STM32RTC::armWeeklySchedule(void)
+{
+  uint8_t days = 0;
+  bool sameTime = true;
+
+  _weeklyRearm = false;
+  if (_weeklyCount == 0) {
+    disableAlarm();
+    return;
+  }
+
+  for (uint8_t i = 0; i < _weeklyCount; i++) {
+    days |= _weeklySchedule[i].weekDays;
+    if ((_weeklySchedule[i].hours != _weeklySchedule[0].hours) ||
+        (_weeklySchedule[i].minutes != _weeklySchedule[0].minutes) ||
+        (_weeklySchedule[i].seconds != _weeklySchedule[0].seconds)) {
+      sameTime = false;
+    }
+  }
+
+  if (!sameTime || ((days != EVERYDAY_MSK) && ((days & (days - 1)) != 0))) {
+    // Program the next occurrence, again each time it expires
+    _weeklyRearm = true;
+    startAlarmEpoch(nextWeeklyAlarm(rawEpoch()), MATCH_WDHHMMSS);
+    return;
+  }
+
+  // Single programming: compute the week day of the only day set
+  uint8_t nextWeekDay = 0;
+  for (uint8_t day = 0; day < 7; day++) {
+    if (days & (1 << day)) {
+      nextWeekDay = day + 1;
+      break;
+    }
+  }
+  _alarmHours = fromHours24(_weeklySchedule[0].hours, &_alarmPeriod, _format == HOUR_12);
+  _alarmMinutes = _weeklySchedule[0].minutes;
+  _alarmSeconds = _weeklySchedule[0].seconds;
+  _alarmSubSeconds = 0;
+  _alarmWeekDay = nextWeekDay;
+  enableAlarm((days == EVERYDAY_MSK) ? MATCH_HHMMSS : MATCH_WDHHMMSS);
+}
+
+/**
+  * @brief  compute the next occurrence of the weekly schedule.
+  * @note   Safe to call from the alarm interrupt: only the schedule is used.
+  * @param  now: current epoch time in seconds
+  * @retval epoch time in seconds of the next occurrence strictly after now
+  */
+uint32_t STM32RTC::nextWeeklyAlarm(uint32_t now)
+{
+  uint32_t delta, minDelta = SECONDS_PER_WEEK;
+  // 1st January 1970 is a Thursday: time since Monday 00:00:00
+  uint32_t timeOfWeek = ((((now / SECONDS_PER_DAY) + 3) % 7) * SECONDS_PER_DAY) + (now % SECONDS_PER_DAY);
+
+  for (uint8_t i = 0; i < _weeklyCount; i++) {
+    for (uint8_t day = 0; day < 7; day++) {
+      if (_weeklySchedule[i].weekDays & (1 << day)) {
+        delta = (day * SECONDS_PER_DAY) + (_weeklySchedule[i].hours * 3600) +
+                (_weeklySchedule[i].minutes * 60) + _weeklySchedule[i].seconds;
+        delta = (delta + SECONDS_PER_WEEK - timeOfWeek) % SECONDS_PER_WEEK;
+        if (delta == 0) {
+          delta = SECONDS_PER_WEEK;
+        }
+        if (delta < minDelta) {
+          minDelta = delta;
+        }
+      }
+    }
+  }
+  return now + minDelta;
+}
+
+/**
+  * @brief  program the RTC alarm for an epoch time without the alarm members.
+  * @note   Used by the persistent alarm queue and the weekly schedule, also
+  *         from the alarm interrupt: the alarm cache is reloaded from the RTC
+  *         by the next alarm getter.
+  * @param  ts: epoch time in seconds, 0 to stop the alarm
+  * @param  match: MATCH_DHHMMSS or MATCH_WDHHMMSS
+  * @retval none
+  */
+void STM32RTC::startAlarmEpoch(uint32_t ts, Alarm_Match match)
+{
+  if (ts == 0) {
+    RTC_StopAlarm();
   } else {
-    _wday = tmp->tm_wday;
+    uint32_t days = ts / SECONDS_PER_DAY;
+    uint32_t timeOfDay = ts % SECONDS_PER_DAY;
+    uint32_t year;
+    uint8_t month, day;
+    AM_PM period;
+
+    if (match & WD_MSK) {
+      // 1st January 1970 is a Thursday
+      day = ((days + 3) % 7) + 1;
+    } else {
+      civilFromDays(days, &year, &month);
+      day = days - daysFromCivil(year, month, 1) + 1;
+    }
+    uint8_t hours = fromHours24(timeOfDay / 3600, &period, RTC_GetHourFormat() == HOUR_FORMAT_12);
+    RTC_StartAlarm(day, hours, (timeOfDay / 60) % 60, timeOfDay % 60, 0,
+                   (period == AM) ? HOUR_AM : HOUR_PM, static_cast<uint8_t>(match));
   }
-  _hours = tmp->tm_hour;
-  _minutes = tmp->tm_min;
-  _seconds = tmp->tm_sec;
-  _subSeconds = subSeconds;
+  _alarmCacheStale = true;
+#if defined(RTC_BKP_ALARM_TARGET)
+  RTC_SetBackupWord(RTC_BKP_ALARM_TARGET, ts);
+#endif /* RTC_BKP_ALARM_TARGET */
+}
 
-  RTC_SetDate(_year, _month, _day, _wday);
-  RTC_SetTime(_hours, _minutes, _seconds, _subSeconds, (_hoursPeriod == AM) ? HOUR_AM : HOUR_PM);
-  _timeSet = true;
+/**
+  * @brief  reload the alarm cache from the RTC if the alarm has been armed
+  *         by startAlarmEpoch().
+  * @retval none
+  */
+void STM32RTC::loadAlarmCache(void)
+{
+  if (_alarmCacheStale) {
+    syncAlarmTime();
+  }
 }
 
 /**
-  * @brief  set RTC time from epoch time since 1st January 2000, 00:00:00
-  * @param  epoch time in seconds
+  * @brief  register the alarm dispatcher if an alarm callback is required.
+  * @note   With the missed alarm detection, the dispatcher is always
+  *         registered to record the next target on each occurrence, even if
+  *         the alarm is only polled.
+  * @retval none
   */
-void STM32RTC::setY2kEpoch(uint32_t ts)
+void STM32RTC::updateAlarmCallback(void)
+{
+#if defined(RTC_BKP_ALARM_TARGET)
+  bool recordTarget = true;
+#else
+  bool recordTarget = false;
+#endif /* RTC_BKP_ALARM_TARGET */
+  if ((_alarmCallback != nullptr) || (_alarmStampCallback != nullptr) ||
+      (_missedAlarmCallback != nullptr) || _weeklyEnabled || _queueActive || recordTarget) {
+    attachAlarmCallback(alarmDispatch, nullptr);
+  } else {
+    detachAlarmCallback();
+  }
+}
+
+/**
+  * @brief  RTC alarm dispatcher, called on alarm interrupt.
+  * @param  data: not used
+  * @retval none
+  */
+void STM32RTC::alarmDispatch(void *data)
 {
-  setEpoch(ts + EPOCH_TIME_OFF);
+  UNUSED(data);
+  STM32RTC &rtc = getInstance();
+  timeStamp_t stamp;
+
+  // Latch the time first, as close as possible to the event. The calendar
+  // and alarm members are not used from the interrupt.
+  stamp.epoch = rawEpoch(&stamp.subSeconds);
+#if defined(RTC_BKP_ALARM_TARGET)
+  // Recorded target elapsed for more than the interrupt latency: the
+  // interrupt has been masked and the previous occurrences are lost
+  uint32_t target = RTC_GetBackupWord(RTC_BKP_ALARM_TARGET);
+  if ((target != 0) && (stamp.epoch > (target + 1))) {
+    rtc._alarmMissed = true;
+    rtc._alarmLateness = stamp.epoch - target;
+  }
+#endif /* RTC_BKP_ALARM_TARGET */
+  if (rtc._queueActive) {
+    rtc.processAlarmQueue();
+  } else if (rtc._weeklyEnabled && rtc._weeklyRearm) {
+    rtc.startAlarmEpoch(rtc.nextWeeklyAlarm(stamp.epoch), MATCH_WDHHMMSS);
+  } else {
+    rtc.recordAlarmTarget();
+  }
+  rtc.deliverMissedAlarm();
+  if (rtc._alarmCallback != nullptr) {
+    rtc._alarmCallback(rtc._alarmCallbackData);
+  }
+  if (rtc._alarmStampCallback != nullptr) {
+    rtc._alarmStampCallback(&stamp, rtc._alarmStampCallbackData);
+  }
 }
 
 /**
@@ -935,6 +3028,7 @@ void STM32RTC::configForLowPower(Source_Clock source)
     uint32_t subSeconds;
     uint8_t seconds, minutes, hours, weekDay, day, month, years;
     uint8_t alarmSeconds, alarmMinutes, alarmHours, alarmDay;
+    loadAlarmCache();
     Alarm_Match alarmMatch = _alarmMatch;
 
     alarmDay = _alarmDay;
@@ -973,8 +3067,114 @@ void STM32RTC::configForLowPower(Source_Clock source)
 void STM32RTC::syncTime(void)
 {
   hourAM_PM_t p = HOUR_AM;
+  uint8_t hours;
   RTC_GetTime(&_hours, &_minutes, &_seconds, &_subSeconds, &p);
-  _hoursPeriod = (p == HOUR_AM) ? AM : PM;
+  hours = toHours24(_hours, (p == HOUR_AM) ? AM : PM, RTC_GetHourFormat() == HOUR_FORMAT_12);
+  _hours = fromHours24(hours, &_hoursPeriod, _format == HOUR_12);
+}
+
+/**
+  * @brief  write the time members to the RTC, converted to the RTC hour format
+  * @param  none
+  */
+void STM32RTC::writeTime(void)
+{
+  writeCalendar(false, true);
+}
+
+/**
+  * @brief  write the date members to the RTC
+  * @param  none
+  */
+void STM32RTC::writeDate(void)
+{
+  writeCalendar(true, false);
+}
+
+/**
+  * @brief  set the time from a time of day literal, already checked
+  * @note   All the time members are written: the RTC time is not read.
+  * @param  hours: 0-23
+  * @param  minutes: 0-59
+  * @param  seconds: 0-59
+  * @retval none
+  */
+void STM32RTC::setTimeOfDay(uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+  _hours = fromHours24(hours, &_hoursPeriod, _format == HOUR_12);
+  _minutes = minutes;
+  _seconds = seconds;
+  _subSeconds = 0;
+  writeTime();
+  _timeSet = true;
+}
+
+/**
+  * @brief  set the alarm time from a time of day literal, already checked
+  * @param  hours: 0-23
+  * @param  minutes: 0-59
+  * @param  seconds: 0-59
+  * @retval none
+  */
+void STM32RTC::setAlarmTimeOfDay(uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+  _alarmHours = fromHours24(hours, &_alarmPeriod, _format == HOUR_12);
+  _alarmMinutes = minutes;
+  _alarmSeconds = seconds;
+  _alarmSubSeconds = 0;
+}
+
+/**
+  * @brief  write the date and/or time members to the RTC, then notify the
+  *         time change callbacks once.
+  * @param  date: true to write the date members
+  * @param  time: true to write the time members
+  */
+void STM32RTC::writeCalendar(bool date, bool time)
+{
+  // Members hold the new values: read the RTC without syncing them
+  uint32_t oldEpoch = rawEpoch();
+
+  if (date) {
+    RTC_SetDate(_year, _month, _day, _wday);
+  }
+  if (time) {
+    AM_PM period;
+    uint8_t hours = toHours24(_hours, _hoursPeriod, _format == HOUR_12);
+    hours = fromHours24(hours, &period, RTC_GetHourFormat() == HOUR_FORMAT_12);
+    RTC_SetTime(hours, _minutes, _seconds, _subSeconds, (period == AM) ? HOUR_AM : HOUR_PM);
+  }
+  recordAlarmTarget();
+
+  uint32_t newEpoch = rawEpoch();
+  if (newEpoch != oldEpoch) {
+    // Keep the monotonic time unchanged
+    _monotonicOffset += newEpoch - oldEpoch;
+#if defined(RTC_BKP_MONOTONIC_OFFSET)
+    RTC_SetBackupWord(RTC_BKP_MONOTONIC_OFFSET, _monotonicOffset);
+#endif /* RTC_BKP_MONOTONIC_OFFSET */
+  }
+  for (uint8_t i = 0; i < _timeChangeCount; i++) {
+    _timeChangeCallbacks[i].callback(oldEpoch, newEpoch, (int32_t)(newEpoch - oldEpoch),
+                                     _timeChangeCallbacks[i].data);
+  }
+}
+
+/**
+  * @brief  program the RTC alarm from the alarm members, converted to the RTC
+  *         hour format
+  * @param  none
+  */
+void STM32RTC::startAlarm(void)
+{
+  AM_PM period;
+  _alarmCacheStale = false;
+  uint8_t hours = toHours24(_alarmHours, _alarmPeriod, _format == HOUR_12);
+  hours = fromHours24(hours, &period, RTC_GetHourFormat() == HOUR_FORMAT_12);
+  RTC_StartAlarm((_alarmMatch & WD_MSK) ? _alarmWeekDay : _alarmDay,
+                 hours, _alarmMinutes, _alarmSeconds,
+                 _alarmSubSeconds, (period == AM) ? HOUR_AM : HOUR_PM,
+                 static_cast<uint8_t>(_alarmMatch));
 }
 
 /**
@@ -987,20 +3187,30 @@ void STM32RTC::syncDate(void)
 }
 
 /**
-  * @brief  synchronise the alarm time from the current RTC one
+  * @brief  synchronise the alarm cache from the current RTC one
   * @param  none
   */
 void STM32RTC::syncAlarmTime(void)
 {
   hourAM_PM_t p = HOUR_AM;
   uint8_t match;
-  RTC_GetAlarm(&_alarmDay, &_alarmHours, &_alarmMinutes, &_alarmSeconds,
+  uint8_t day = 1;
+  uint8_t hours;
+  _alarmCacheStale = false;
+  RTC_GetAlarm(&day, &_alarmHours, &_alarmMinutes, &_alarmSeconds,
                &_alarmSubSeconds, &p, &match);
-  _alarmPeriod = (p == HOUR_AM) ? AM : PM;
+  if (match & WD_MSK) {
+    _alarmWeekDay = day;
+  } else {
+    _alarmDay = day;
+  }
+  hours = toHours24(_alarmHours, (p == HOUR_AM) ? AM : PM, RTC_GetHourFormat() == HOUR_FORMAT_12);
+  _alarmHours = fromHours24(hours, &_alarmPeriod, _format == HOUR_12);
   switch (static_cast<Alarm_Match>(match)) {
     case MATCH_OFF:
     case MATCH_YYMMDDHHMMSS://kept for compatibility
     case MATCH_MMDDHHMMSS:  //kept for compatibility
+    case MATCH_WDHHMMSS:
     case MATCH_DHHMMSS:
     case MATCH_HHMMSS:
     case MATCH_MMSS:
@@ -1012,3 +3222,71 @@ void STM32RTC::syncAlarmTime(void)
       break;
   }
 }
+
+/**
+  * @brief  compute the next epoch matching the alarm configuration
+  * @note   Only integer math on now and the alarm members, no RTC access.
+  * @param  now: current epoch
+  * @retval next epoch strictly after now matching the alarm or 0 if the
+  *         alarm match is MATCH_OFF
+  */
+uint32_t STM32RTC::nextAlarmEpoch(uint32_t now)
+{
+  uint32_t timeOfDay = (toHours24(_alarmHours, _alarmPeriod, _format == HOUR_12) * 3600) +
+                       (_alarmMinutes * 60) + _alarmSeconds;
+
+  return alarmEpochAfter(now, _alarmMatch, (_alarmMatch == MATCH_WDHHMMSS) ? _alarmWeekDay : _alarmDay,
+                         timeOfDay);
+}
+
+/**
+  * @brief  record the next target of the armed alarm in backup register to
+  *         detect a missed alarm.
+  * @note   The target is computed from the alarm registers, the alarm
+  *         members are not updated: safe to call from an interrupt.
+  * @param  none
+  */
+void STM32RTC::recordAlarmTarget(void)
+{
+#if defined(RTC_BKP_ALARM_TARGET)
+  uint32_t target = 0;
+
+  if (RTC_IsAlarmSet()) {
+    target = armedAlarmEpochAfter(rawEpoch());
+  }
+  RTC_SetBackupWord(RTC_BKP_ALARM_TARGET, target);
+#endif /* RTC_BKP_ALARM_TARGET */
+}
+
+/**
+  * @brief  check if the alarm recorded in backup register has been missed.
+  * @param  none
+  */
+void STM32RTC::checkMissedAlarm(void)
+{
+#if defined(RTC_BKP_ALARM_TARGET)
+  uint32_t target = RTC_GetBackupWord(RTC_BKP_ALARM_TARGET);
+
+  if (target != 0) {
+    uint32_t now = getEpoch();
+    if (now > target) {
+      _alarmMissed = true;
+      _alarmLateness = now - target;
+    }
+  }
+  recordAlarmTarget();
+  deliverMissedAlarm();
+#endif /* RTC_BKP_ALARM_TARGET */
+}
+
+/**
+  * @brief  call the missed alarm callback if an alarm has been missed.
+  * @param  none
+  */
+void STM32RTC::deliverMissedAlarm(void)
+{
+  if (_alarmMissed && (_missedAlarmCallback != nullptr)) {
+    _alarmMissed = false;
+    _missedAlarmCallback(_alarmLateness, _missedAlarmCallbackData);
+  }
+}
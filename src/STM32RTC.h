@@ -38,6 +38,8 @@
 #define __STM32_RTC_H
 
 #include "Arduino.h"
+#include <limits>
+#include <type_traits>
 #if defined(STM32_CORE_VERSION) && (STM32_CORE_VERSION  > 0x01090000)
   #include "rtc.h"
 #endif
@@ -65,11 +67,128 @@
                                         |(STM32_RTC_VERSION_EXTRA))
 
 typedef void(*voidFuncPtr)(void *);
+typedef void(*missedAlarmFuncPtr)(uint32_t lateness, void *);
+
+/* Time latched once at interrupt entry and shared by all its callbacks */
+typedef struct {
+  uint32_t epoch;      // seconds since 1970
+  uint32_t subSeconds; // ms
+} timeStamp_t;
+typedef void(*timeStampFuncPtr)(const timeStamp_t *stamp, void *);
+typedef void(*timeChangeFuncPtr)(uint32_t oldEpoch, uint32_t newEpoch, int32_t step, void *);
+typedef void(*tamperFuncPtr)(uint8_t tamper, const timeStamp_t *stamp, void *);
+typedef int32_t(*temperatureFuncPtr)(void *); // temperature in 0.01 °C
+
+/* Number of tamper inputs managed by the library */
+#define RTC_TAMPER_COUNT 3
+
+/* Maximum number of time change callbacks */
+#ifndef RTC_TIME_CHANGE_CALLBACKS
+#define RTC_TIME_CHANGE_CALLBACKS 4
+#endif
+
+/* Leap seconds between UTC and GPS time (18 since 2017-01-01) */
+#ifndef RTC_GPS_LEAP_SECONDS
+#define RTC_GPS_LEAP_SECONDS 18
+#endif
+
+/* Offset of a synchronization not known: no drift observation for the aging */
+#define RTC_SYNC_OFFSET_UNKNOWN INT32_MIN
 
 #define IS_CLOCK_SOURCE(SRC) (((SRC) == STM32RTC::LSI_CLOCK) || ((SRC) == STM32RTC::LSE_CLOCK) ||\
                               ((SRC) == STM32RTC::HSE_CLOCK))
 #define IS_HOUR_FORMAT(FMT)  (((FMT) == STM32RTC::HOUR_12) || ((FMT) == STM32RTC::HOUR_24))
 
+/*
+ * Time of day literals, validated at compile time:
+ *   using namespace STM32RTCLiterals;
+ *   rtc.setAlarmTime(7_h + 30_min);
+ */
+namespace STM32RTCLiterals {
+
+// Units given in a time of day literal
+enum : uint8_t {
+  TIME_HOURS   = 0x01,
+  TIME_MINUTES = 0x02,
+  TIME_SECONDS = 0x04
+};
+
+template<uint8_t Units> class TimeOfDay;
+template<char... Digits> constexpr TimeOfDay<TIME_HOURS> operator"" _h(void);
+template<char... Digits> constexpr TimeOfDay<TIME_MINUTES> operator"" _min(void);
+template<char... Digits> constexpr TimeOfDay<TIME_SECONDS> operator"" _s(void);
+
+// Only built by the literals and their sum, so always a valid time of day
+template<uint8_t Units> class TimeOfDay {
+  public:
+    constexpr uint8_t hours(void) const
+    {
+      return _seconds / 3600;
+    }
+    constexpr uint8_t minutes(void) const
+    {
+      return (_seconds / 60) % 60;
+    }
+    constexpr uint8_t seconds(void) const
+    {
+      return _seconds % 60;
+    }
+    constexpr uint32_t secondsOfDay(void) const
+    {
+      return _seconds;
+    }
+
+    template<uint8_t Other> constexpr TimeOfDay<(Units | Other)> operator+(TimeOfDay<Other> time) const
+    {
+      static_assert((Units & Other) == 0, "time unit given twice");
+      return TimeOfDay<(Units | Other)>(_seconds + time.secondsOfDay());
+    }
+
+  private:
+    constexpr explicit TimeOfDay(uint32_t seconds) : _seconds(seconds) {}
+
+    template<uint8_t Other> friend class TimeOfDay;
+    template<char... Digits> friend constexpr TimeOfDay<TIME_HOURS> operator"" _h(void);
+    template<char... Digits> friend constexpr TimeOfDay<TIME_MINUTES> operator"" _min(void);
+    template<char... Digits> friend constexpr TimeOfDay<TIME_SECONDS> operator"" _s(void);
+
+    uint32_t _seconds;
+};
+
+// Value of a decimal literal, UINT32_MAX if it is not decimal
+template<char... Digits> constexpr uint32_t literalValue(void)
+{
+  const char digits[] = {Digits...};
+  uint32_t value = 0;
+  for (char c : digits) {
+    if ((c < '0') || (c > '9') || (value > 9999)) {
+      return UINT32_MAX;
+    }
+    value = (value * 10) + (c - '0');
+  }
+  return value;
+}
+
+template<char... Digits> constexpr TimeOfDay<TIME_HOURS> operator"" _h(void)
+{
+  static_assert(literalValue<Digits...>() < 24, "hours must be 0-23");
+  return TimeOfDay<TIME_HOURS>(literalValue<Digits...>() * 3600);
+}
+
+template<char... Digits> constexpr TimeOfDay<TIME_MINUTES> operator"" _min(void)
+{
+  static_assert(literalValue<Digits...>() < 60, "minutes must be 0-59");
+  return TimeOfDay<TIME_MINUTES>(literalValue<Digits...>() * 60);
+}
+
+template<char... Digits> constexpr TimeOfDay<TIME_SECONDS> operator"" _s(void)
+{
+  static_assert(literalValue<Digits...>() < 60, "seconds must be 0-59");
+  return TimeOfDay<TIME_SECONDS>(literalValue<Digits...>());
+}
+
+} // namespace STM32RTCLiterals
+
 class STM32RTC {
   public:
 
@@ -89,6 +208,7 @@ class STM32RTC {
       MATCH_MMSS         = SS_MSK | MM_MSK,                  // Every Hour
       MATCH_HHMMSS       = SS_MSK | MM_MSK | HH_MSK,         // Every Day
       MATCH_DHHMMSS      = SS_MSK | MM_MSK | HH_MSK | D_MSK, // Every Month
+      MATCH_WDHHMMSS     = SS_MSK | MM_MSK | HH_MSK | D_MSK | WD_MSK, // Every Week
       /* NOTE: STM32 RTC can't assign a month or a year to an alarm. Those enum
       are kept for compatibility but are ignored inside enableAlarm(). */
       MATCH_MMDDHHMMSS   = SS_MSK | MM_MSK | HH_MSK | D_MSK | M_MSK,
@@ -101,6 +221,278 @@ class STM32RTC {
       HSE_CLOCK = ::HSE_CLOCK
     };
 
+    enum Week_Day_Mask : uint8_t {
+      MONDAY_MSK    = 0x01,
+      TUESDAY_MSK   = 0x02,
+      WEDNESDAY_MSK = 0x04,
+      THURSDAY_MSK  = 0x08,
+      FRIDAY_MSK    = 0x10,
+      SATURDAY_MSK  = 0x20,
+      SUNDAY_MSK    = 0x40,
+      WORKDAYS_MSK  = 0x1F,
+      WEEKEND_MSK   = 0x60,
+      EVERYDAY_MSK  = 0x7F
+    };
+
+    enum Tamper_Trigger : uint8_t {
+      TAMPER_RISING_EDGE  = ::TAMPER_RISING_EDGE,
+      TAMPER_FALLING_EDGE = ::TAMPER_FALLING_EDGE,
+      TAMPER_LOW_LEVEL    = ::TAMPER_LOW_LEVEL,
+      TAMPER_HIGH_LEVEL   = ::TAMPER_HIGH_LEVEL
+    };
+
+    struct Tamper_Config {
+      Tamper_Trigger trigger;
+      uint8_t     filter;      // 0 (edge) or 2, 4, 8 consecutive samples (level)
+      uint16_t    samplingDiv; // RTCCLK divider of the level sampling: 256-32768
+      uint8_t     precharge;   // 0 (no pull-up) or 1, 2, 4, 8 RTCCLK cycles
+      bool        timeStamp;   // Save a time stamp on detection
+      bool        noErase;     // Keep the backup registers on detection
+    };
+
+    enum Wake_Reason : uint8_t {
+      WAKE_NONE      = RTC_WAKE_NONE,
+      WAKE_ALARM_A   = RTC_WAKE_ALARM_A,
+      WAKE_ALARM_B   = RTC_WAKE_ALARM_B,
+      WAKE_TIMER     = RTC_WAKE_TIMER,
+      WAKE_TIMESTAMP = RTC_WAKE_TIMESTAMP,
+      WAKE_TAMPER    = RTC_WAKE_TAMPER,
+      WAKE_STANDBY   = RTC_WAKE_STANDBY
+    };
+
+    enum Sync_Source : uint8_t {
+      SYNC_NONE    = 0, // Never synchronized
+      SYNC_MANUAL  = 1,
+      SYNC_NETWORK = 2,
+      SYNC_GNSS    = 3,
+      SYNC_OTHER   = 4
+    };
+
+    enum Pps_Input : uint8_t {
+      PPS_TIMESTAMP_RISING,  // Time stamp input (RTC_TS pin)
+      PPS_TIMESTAMP_FALLING,
+      PPS_INTERRUPT          // ppsEdge() called from a pin interrupt
+    };
+
+    enum Pps_State : uint8_t {
+      PPS_OFF,       // Discipline disabled
+      PPS_ACQUIRING, // Phase stepped on the next edge
+      PPS_TRACKING,  // Frequency converging
+      PPS_LOCKED,    // Phase within one tick and frequency within 1 ppm
+      PPS_HOLDOVER   // Edges lost, frequency correction kept
+    };
+
+    struct Pps_Status {
+      Pps_State   state;
+      int32_t     phase;       // Last phase error in ns, positive when the RTC is ahead
+      int32_t     frequency;   // Last frequency error in ppb, positive when the RTC is fast
+      int32_t     correction;  // Frequency correction of the discipline in ppb
+      uint32_t    edges;       // Edges captured
+    };
+
+    struct Alarm_Config {
+      uint8_t     day;
+      uint8_t     weekDay;
+      uint8_t     hours;
+      uint8_t     minutes;
+      uint8_t     seconds;
+      uint32_t    subSeconds;
+      AM_PM       period;
+      Alarm_Match match;
+    };
+
+    // Frequency correction of the crystal at a temperature
+    struct Temperature_Point {
+      int16_t     temperature; // 0.01 °C
+      int32_t     correction;  // ppb, positive to speed the RTC up
+    };
+
+    struct Temperature_Model {
+      int16_t     turnover;    // Turnover temperature in 0.01 °C, typically 2500
+      uint16_t    coefficient; // Parabolic coefficient in ppb/°C², typically 34
+      const Temperature_Point *table; // Used instead of the parabola if not nullptr
+      uint8_t     tableSize;   // Points sorted by temperature
+    };
+
+    // Epoch starting at Base (Unix time of its origin), counted in 1/Units s
+    template<typename T, int64_t Base, uint32_t Units = 1> struct Epoch_Format {
+      typedef T type;
+
+      // Seconds from the origin to the first and last second of the RTC calendar (2000-2099)
+      static constexpr int64_t rangeFirst = 946684800 - Base;
+      static constexpr int64_t rangeLast = 4102444799 - Base;
+      static_assert(std::is_integral<T>::value && (Units != 0), "epoch format must count integer units");
+      // A 32-bit count of seconds wraps like the Unix time (NTP eras), others must not wrap
+      static_assert(((Units == 1) && (sizeof(T) == 4) && std::is_unsigned<T>::value) ||
+                    ((rangeLast >= 0) && ((uint64_t)rangeLast <= ((uint64_t)std::numeric_limits<T>::max() / Units)) &&
+                     ((rangeFirst >= 0) || (std::is_signed<T>::value &&
+                                            (rangeFirst >= ((int64_t)std::numeric_limits<T>::min() / (int64_t)Units))))),
+                    "epoch format type can not hold the RTC calendar range from this origin");
+
+      // Units below 1 ms are not provided by the RTC subseconds
+      static constexpr T fromUnix(uint32_t seconds, uint32_t subSeconds)
+      {
+        return (T)(((uint64_t)((int64_t)seconds - Base) * Units) +
+                   ((Units == 1) ? 0 : (((uint64_t)subSeconds * Units) / 1000)));
+      }
+      static constexpr uint32_t toUnix(T ts)
+      {
+        return (uint32_t)(Base + ((std::is_signed<T>::value ? ((int64_t)ts - (int64_t)remainder(ts)) :
+                                   (int64_t)((uint64_t)ts - remainder(ts))) / (int64_t)Units));
+      }
+      static constexpr uint32_t toSubSeconds(T ts)
+      {
+        return (uint32_t)(((uint64_t)remainder(ts) * 1000) / Units);
+      }
+      // Units elapsed in the second, also before the origin
+      static constexpr uint32_t remainder(T ts)
+      {
+        return std::is_signed<T>::value ?
+               (uint32_t)((((int64_t)ts % (int64_t)Units) + (int64_t)Units) % (int64_t)Units) :
+               (uint32_t)((uint64_t)ts % Units);
+      }
+    };
+    typedef Epoch_Format<uint32_t, 0>           Unix_Epoch;     // 1970-01-01
+    typedef Epoch_Format<uint64_t, 0, 1000>     Unix_Epoch_Ms;
+    typedef Epoch_Format<uint32_t, 946684800>   Y2k_Epoch;      // 2000-01-01
+    typedef Epoch_Format<uint32_t, 1577836800>  Epoch_2020;     // 2020-01-01
+    typedef Epoch_Format<uint32_t, 315964800>   Utc_1980_Epoch; // 1980-01-06, without leap seconds
+    // GPS time: 1980-01-06 plus the leap seconds inserted in UTC since then
+    typedef Epoch_Format<uint32_t, 315964800 - RTC_GPS_LEAP_SECONDS> Gps_Epoch;
+    typedef Epoch_Format<uint32_t, -2208988800> Ntp_Epoch;      // 1900-01-01, wraps with the NTP eras
+
+    // Alarm precomputed in RTC register format by prepareAlarm()
+    struct Alarm_Descriptor {
+      Alarm_Config config;
+#if !defined(STM32F1xx)
+      alarmRegs_t  regs;
+#endif /* !STM32F1xx */
+    };
+
+    // Elapsed time measurement on raw RTC register snapshots
+    class Stopwatch {
+      public:
+        void start(void);
+        int64_t elapsedTicks(void) const;
+        int64_t elapsedMicros(void) const;
+        int64_t elapsedMillis(void) const;
+        static uint32_t ticksPerSecond(void);
+
+      private:
+        rawTime_t _start;
+    };
+
+    // Date and time snapshot in 24 hours format, subseconds in ms
+    class DateTime {
+      public:
+        constexpr DateTime(void) : DateTime(0, 1, 1) {}
+        constexpr DateTime(uint8_t year, uint8_t month, uint8_t day, uint8_t hours = 0, uint8_t minutes = 0,
+                           uint8_t seconds = 0, uint16_t subSeconds = 0, uint8_t weekDay = 0) :
+          _year(year), _month(month), _day(day),
+          _weekDay((weekDay != 0) ? weekDay : weekDayFromDays(daysFromCivil(year + 2000, month, day))),
+          _hours(hours), _minutes(minutes), _seconds(seconds), _subSeconds(subSeconds) {}
+
+        constexpr uint8_t year(void) const
+        {
+          return _year;
+        }
+        constexpr uint8_t month(void) const
+        {
+          return _month;
+        }
+        constexpr uint8_t day(void) const
+        {
+          return _day;
+        }
+        constexpr uint8_t weekDay(void) const
+        {
+          return _weekDay;
+        }
+        constexpr uint8_t hours(void) const
+        {
+          return _hours;
+        }
+        constexpr uint8_t minutes(void) const
+        {
+          return _minutes;
+        }
+        constexpr uint8_t seconds(void) const
+        {
+          return _seconds;
+        }
+        constexpr uint16_t subSeconds(void) const
+        {
+          return _subSeconds;
+        }
+        // Seconds since 1970
+        constexpr uint32_t epoch(void) const
+        {
+          return (daysFromCivil(_year + 2000, _month, _day) * 86400) + (_hours * 3600) + (_minutes * 60) + _seconds;
+        }
+
+        // The week day is not compared, it is implied by the date
+        friend constexpr bool operator==(const DateTime &a, const DateTime &b)
+        {
+          return a.key() == b.key();
+        }
+        friend constexpr bool operator!=(const DateTime &a, const DateTime &b)
+        {
+          return a.key() != b.key();
+        }
+        friend constexpr bool operator<(const DateTime &a, const DateTime &b)
+        {
+          return a.key() < b.key();
+        }
+        friend constexpr bool operator<=(const DateTime &a, const DateTime &b)
+        {
+          return a.key() <= b.key();
+        }
+        friend constexpr bool operator>(const DateTime &a, const DateTime &b)
+        {
+          return a.key() > b.key();
+        }
+        friend constexpr bool operator>=(const DateTime &a, const DateTime &b)
+        {
+          return a.key() >= b.key();
+        }
+
+        // Number of days since 1st January 1970 of a full year (>= 1970)
+        static constexpr uint32_t daysFromCivil(uint32_t year, uint32_t month, uint32_t day)
+        {
+          // Shift the year start to March so that the leap day is the last one
+          return ((((month <= 2) ? (year - 1) : year) / 400) * 146097) +
+                 yoeDays(((month <= 2) ? (year - 1) : year) % 400) +
+                 (((153 * ((month <= 2) ? (month + 9) : (month - 3))) + 2) / 5) + day - 1 - 719468;
+        }
+        // 1 (Monday) to 7 (Sunday)
+        static constexpr uint8_t weekDayFromDays(uint32_t days)
+        {
+          // 1st January 1970 was a Thursday
+          return ((days + 3) % 7) + 1;
+        }
+
+      private:
+        static constexpr uint32_t yoeDays(uint32_t yoe)
+        {
+          return (yoe * 365) + (yoe / 4) - (yoe / 100);
+        }
+        // Fields packed in their significance order, subseconds < 1024
+        constexpr uint64_t key(void) const
+        {
+          return ((uint64_t)_year << 36) | ((uint64_t)_month << 32) | ((uint64_t)_day << 27) |
+                 ((uint32_t)_hours << 22) | ((uint32_t)_minutes << 16) | ((uint32_t)_seconds << 10) | _subSeconds;
+        }
+
+        uint8_t  _year;  // 0-99 since 2000
+        uint8_t  _month;
+        uint8_t  _day;
+        uint8_t  _weekDay;
+        uint8_t  _hours; // 0-23
+        uint8_t  _minutes;
+        uint8_t  _seconds;
+        uint16_t _subSeconds;
+    };
+
     static STM32RTC &getInstance()
     {
       static STM32RTC instance; // Guaranteed to be destroyed.
@@ -119,16 +511,38 @@ class STM32RTC {
     Source_Clock getClockSource(void);
     void setClockSource(Source_Clock source);
 
+    Hour_Format getHourFormat(void);
+    void setHourFormat(Hour_Format format);
+
     void enableAlarm(Alarm_Match match);
+    bool prepareAlarm(Alarm_Descriptor &alarm, const Alarm_Config &config);
+    void enableAlarm(const Alarm_Descriptor &alarm);
     void disableAlarm(void);
+    void getAlarmWriteStats(uint32_t *writes, uint32_t *skipped = nullptr);
 
     void attachInterrupt(voidFuncPtr callback, void *data = nullptr);
     void detachInterrupt(void);
+    void attachTimeStampInterrupt(timeStampFuncPtr callback, void *data = nullptr);
+    void detachTimeStampInterrupt(void);
+
+    void attachMissedAlarmCallback(missedAlarmFuncPtr callback, void *data = nullptr);
+    void detachMissedAlarmCallback(void);
+
+    bool attachTimeChangeCallback(timeChangeFuncPtr callback, void *data = nullptr);
+    void detachTimeChangeCallback(timeChangeFuncPtr callback);
+
+    /* Tamper Functions */
+
+    bool enableTamper(uint8_t tamper, const Tamper_Config &config, tamperFuncPtr callback, void *data = nullptr);
+    void disableTamper(uint8_t tamper);
+    uint32_t getTamperSamplingRate(const Tamper_Config &config);
 
 #ifdef ONESECOND_IRQn
     // Other mcu than stm32F1 will use the WakeUp feature to interrupt each second.
     void attachSecondsInterrupt(voidFuncPtr callback);
     void detachSecondsInterrupt(void);
+    void attachSecondsTimeStampInterrupt(timeStampFuncPtr callback, void *data = nullptr);
+    void detachSecondsTimeStampInterrupt(void);
 
 #endif /* ONESECOND_IRQn */
     // Kept for compatibility: use STM32LowPower library.
@@ -148,12 +562,16 @@ class STM32RTC {
     uint8_t getYear(void);
     void getDate(uint8_t *weekDay, uint8_t *day, uint8_t *month, uint8_t *year);
 
+    DateTime getDateTime(void);
+
     uint32_t getAlarmSubSeconds(void);
     uint8_t getAlarmSeconds(void);
     uint8_t getAlarmMinutes(void);
     uint8_t getAlarmHours(AM_PM *period = nullptr);
 
     uint8_t getAlarmDay(void);
+    uint8_t getAlarmWeekDay(void);
+    Alarm_Config getAlarm(void);
 
     // Kept for compatibility with Arduino RTCZero library.
     uint8_t getAlarmMonth();
@@ -166,6 +584,11 @@ class STM32RTC {
     void setMinutes(uint8_t minutes);
     void setHours(uint8_t hours, AM_PM period = AM);
     void setTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds = 1000, AM_PM period = AM);
+    // Time of day literal, checked at compile time
+    template<uint8_t Units> void setTime(STM32RTCLiterals::TimeOfDay<Units> time)
+    {
+      setTimeOfDay(time.hours(), time.minutes(), time.seconds());
+    }
 
     void setWeekDay(uint8_t weekDay);
     void setDay(uint8_t day);
@@ -179,8 +602,13 @@ class STM32RTC {
     void setAlarmMinutes(uint8_t minutes);
     void setAlarmHours(uint8_t hours, AM_PM period = AM);
     void setAlarmTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds = 0, AM_PM period = AM);
+    template<uint8_t Units> void setAlarmTime(STM32RTCLiterals::TimeOfDay<Units> time)
+    {
+      setAlarmTimeOfDay(time.hours(), time.minutes(), time.seconds());
+    }
 
     void setAlarmDay(uint8_t day);
+    void setAlarmWeekDay(uint8_t weekDay);
 
     // Kept for compatibility with Arduino RTCZero library.
     void setAlarmMonth(uint8_t month);
@@ -190,11 +618,117 @@ class STM32RTC {
     /* Epoch Functions */
 
     uint32_t getEpoch(uint32_t *subSeconds = nullptr);
+    uint32_t getNextAlarmEpoch(void);
+    uint32_t getMonotonic(uint32_t *subSeconds = nullptr);
     uint32_t getY2kEpoch(void);
     void setEpoch(uint32_t ts, uint32_t subSeconds = 0);
+    // Epoch in another format, the offset is a compile time constant
+    template<class Format> typename Format::type getEpoch(uint32_t *subSeconds = nullptr)
+    {
+      uint32_t ms;
+      uint32_t ts = getEpoch(&ms);
+      if (subSeconds != nullptr) {
+        *subSeconds = ms;
+      }
+      return Format::fromUnix(ts, ms);
+    }
+    template<class Format> void setEpoch(typename Format::type ts)
+    {
+      setEpoch(Format::toUnix(ts), Format::toSubSeconds(ts));
+    }
     void setY2kEpoch(uint32_t ts);
     void setAlarmEpoch(uint32_t ts, Alarm_Match match = MATCH_DHHMMSS, uint32_t subSeconds = 0);
 
+    /* Calibration Functions */
+
+    void setCalibration(int32_t ppb);
+    int32_t getCalibration(void);
+    void enableTemperatureCompensation(const Temperature_Model &model, temperatureFuncPtr source,
+                                       void *data = nullptr, uint32_t period = 60);
+    void disableTemperatureCompensation(void);
+    bool updateTemperatureCompensation(void);
+    int32_t getTemperatureCorrection(void);
+    void setAgingRate(int32_t ppbPerYear, bool fitted = true);
+    int32_t getAgingRate(void);
+    int32_t getAgingCorrection(void);
+
+    /* PPS discipline Functions */
+
+    bool enablePpsDiscipline(Pps_Input input = PPS_TIMESTAMP_RISING);
+    void disablePpsDiscipline(void);
+    void ppsEdge(void);
+    bool updatePpsDiscipline(void);
+    Pps_State getPpsState(void);
+    Pps_Status getPpsStatus(void);
+
+    /* Time quality Functions */
+
+    void setSyncSource(Sync_Source source, uint32_t accuracy = 0, int32_t offset = RTC_SYNC_OFFSET_UNKNOWN);
+    Sync_Source getSyncSource(void);
+    uint32_t getLastSyncEpoch(void);
+    void setDriftPpm(uint32_t ppm);
+    uint32_t getDriftPpm(void);
+    uint32_t getTimeUncertainty(void);
+
+    /* Synchronized actions Functions */
+
+    uint32_t waitForSecondEdge(uint32_t *jitter = nullptr);
+    bool scheduleAt(uint32_t ts, uint32_t subSeconds, timeStampFuncPtr callback, void *data = nullptr);
+    void cancelScheduleAt(void);
+    uint32_t getSyncJitter(void);
+
+#if defined(BKPSRAM_BASE)
+    /* Backup SRAM Functions */
+
+    uint32_t getBackupSramSize(void)
+    {
+      return RTC_BKPSRAM_SIZE;
+    }
+    void *getBackupSram(void)
+    {
+      return RTC_BkpSramEnable();
+    }
+    // Direct access to a typed region of the backup SRAM, nullptr if out of
+    // it or misaligned for T (the backup SRAM base is aligned)
+    template<typename T> T *mapBackupSram(uint32_t offset = 0)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "backup SRAM type must be trivially copyable");
+      if ((offset > RTC_BKPSRAM_SIZE) || (sizeof(T) > (RTC_BKPSRAM_SIZE - offset)) ||
+          ((offset % alignof(T)) != 0)) {
+        return nullptr;
+      }
+      return reinterpret_cast<T *>(static_cast<uint8_t *>(getBackupSram()) + offset);
+    }
+    // Backup SRAM is writable during the session lifetime
+    class BackupSramSession {
+      public:
+        BackupSramSession(void) : _keepEnabled(RTC_BkpSramWriteBegin()) {}
+        ~BackupSramSession(void)
+        {
+          RTC_BkpSramWriteEnd(_keepEnabled);
+        }
+        BackupSramSession(const BackupSramSession &) = delete;
+        BackupSramSession &operator=(const BackupSramSession &) = delete;
+
+      private:
+        bool _keepEnabled;
+    };
+
+#endif /* BKPSRAM_BASE */
+    /* Persistent alarm queue Functions */
+
+    bool setQueuedAlarm(uint8_t id, uint32_t ts, uint32_t period = 0);
+    bool cancelQueuedAlarm(uint8_t id);
+    bool attachQueuedAlarmHandler(uint8_t id, voidFuncPtr callback, void *data = nullptr);
+    void detachQueuedAlarmHandler(uint8_t id);
+
+    /* Weekly schedule Functions */
+
+    bool addWeeklyAlarm(uint8_t weekDays, uint8_t hours, uint8_t minutes, uint8_t seconds = 0);
+    void clearWeeklySchedule(void);
+    void enableWeeklySchedule(void);
+    void disableWeeklySchedule(void);
+
 #if defined(STM32F1xx)
     void getPrediv(uint32_t *predivA, int16_t *dummy = nullptr);
     void setPrediv(uint32_t predivA, int16_t dummy = 0);
@@ -210,6 +744,11 @@ class STM32RTC {
     {
       return RTC_IsAlarmSet();
     }
+    // Can be called before begin()
+    static uint8_t getWakeReason(void)
+    {
+      return RTC_GetWakeReason();
+    }
     bool isTimeSet(void)
     {
 #if defined(STM32_CORE_VERSION) && (STM32_CORE_VERSION  > 0x01050000)
@@ -222,7 +761,36 @@ class STM32RTC {
     friend class STM32LowPower;
 
   private:
-    STM32RTC(void): _clockSource(LSI_CLOCK) {}
+    STM32RTC(void): _clockSource(LSI_CLOCK), _epochDateKey(0), _epochDateBase(0),
+      _alarmCallback(nullptr), _alarmCallbackData(nullptr),
+      _alarmStampCallback(nullptr), _alarmStampCallbackData(nullptr),
+      _secondsCallback(nullptr),
+      _secondsStampCallback(nullptr), _secondsStampCallbackData(nullptr),
+      _weeklyCount(0), _weeklyEnabled(false), _weeklyRearm(false),
+      _missedAlarmCallback(nullptr), _missedAlarmCallbackData(nullptr),
+      _alarmMissed(false), _alarmLateness(0), _queueActive(false),
+      _queueBusy(false), _queueRescan(false), _alarmCacheStale(false),
+      _syncCallback(nullptr), _syncCallbackData(nullptr), _syncWaiting(false),
+      _syncEdge(false), _syncTargetTicks(0), _syncJitter(0), _timeChangeCount(0),
+      _monotonicOffset(0), _syncMonotonic(0), _syncInfo(0), _driftPpm(0),
+      _calibration(0), _calibrationOffset(0), _temperatureCorrection(0),
+      _temperatureSource(nullptr), _temperatureSourceData(nullptr),
+      _temperaturePeriod(0), _temperatureUpdate(0),
+      _agingBase(0), _agingRate(0), _agingFitted(false),
+      _ppsState(PPS_OFF), _ppsInput(PPS_INTERRUPT), _ppsCount(0), _ppsTicks(0),
+      _ppsTicksPerSecond(1), _ppsProcessed(0), _ppsLastEdge(0), _ppsWindow(0),
+      _ppsWindowStart(0), _ppsSamples(0), _ppsSumX(0), _ppsSumY(0), _ppsSumXX(0),
+      _ppsSumXY(0), _ppsSumCalibration(0), _ppsPhase(0), _ppsFrequency(0),
+      _ppsShifted(0), _ppsCorrection(0)
+    {
+      for (uint8_t i = 0; i < RTC_TAMPER_COUNT; i++) {
+        _tamperCallbacks[i] = nullptr;
+        _tamperCallbacksData[i] = nullptr;
+      }
+      for (uint8_t i = 0; i < RTC_ALARM_QUEUE_SIZE; i++) {
+        _queueHandlers[i].callback = nullptr;
+      }
+    }
 
     static bool _timeSet;
 
@@ -238,6 +806,7 @@ class STM32RTC {
     uint8_t     _wday;
 
     uint8_t     _alarmDay;
+    uint8_t     _alarmWeekDay;
     uint8_t     _alarmHours;
     uint8_t     _alarmMinutes;
     uint8_t     _alarmSeconds;
@@ -247,12 +816,163 @@ class STM32RTC {
 
     Source_Clock _clockSource;
 
+    // Epoch of the current day midnight, keyed by the raw RTC date
+    uint32_t    _epochDateKey;
+    uint32_t    _epochDateBase;
+
+    voidFuncPtr _alarmCallback;
+    void        *_alarmCallbackData;
+    timeStampFuncPtr _alarmStampCallback;
+    void        *_alarmStampCallbackData;
+
+    voidFuncPtr _secondsCallback;
+    timeStampFuncPtr _secondsStampCallback;
+    void        *_secondsStampCallbackData;
+
+    struct Weekly_Alarm {
+      uint8_t weekDays;
+      uint8_t hours;
+      uint8_t minutes;
+      uint8_t seconds;
+    };
+    Weekly_Alarm _weeklySchedule[RTC_WEEKLY_SCHEDULE_SIZE];
+    uint8_t     _weeklyCount;
+    bool        _weeklyEnabled;
+    bool        _weeklyRearm;
+
+    missedAlarmFuncPtr _missedAlarmCallback;
+    void        *_missedAlarmCallbackData;
+    bool        _alarmMissed;
+    uint32_t    _alarmLateness;
+
+    struct Queued_Handler {
+      uint8_t     id;
+      voidFuncPtr callback;
+      void        *data;
+    };
+    Queued_Handler _queueHandlers[RTC_ALARM_QUEUE_SIZE];
+    bool        _queueActive;
+    volatile bool _queueBusy;
+    volatile bool _queueRescan;
+
+    // Alarm armed by startAlarmEpoch(): the cache must be read from the RTC
+    volatile bool _alarmCacheStale;
+
+    volatile timeStampFuncPtr _syncCallback;
+    void        *_syncCallbackData;
+    volatile bool _syncWaiting;
+    volatile bool _syncEdge;
+    uint32_t    _syncTargetTicks;
+    volatile uint32_t _syncJitter;
+    timeStamp_t _syncStamp;
+
+    struct Time_Change_Callback {
+      timeChangeFuncPtr callback;
+      void        *data;
+    };
+    Time_Change_Callback _timeChangeCallbacks[RTC_TIME_CHANGE_CALLBACKS];
+    uint8_t     _timeChangeCount;
+
+    // Sum of the calendar steps: monotonic time is epoch - offset
+    uint32_t    _monotonicOffset;
+
+    // Monotonic time of the last synchronization, accuracy << 8 | source
+    uint32_t    _syncMonotonic;
+    uint32_t    _syncInfo;
+    uint32_t    _driftPpm;
+
+    // Calibration applied (ppb) and its components
+    int32_t     _calibration;
+    int32_t     _calibrationOffset;
+    int32_t     _temperatureCorrection;
+
+    Temperature_Model _temperatureModel;
+    temperatureFuncPtr _temperatureSource;
+    void        *_temperatureSourceData;
+    uint32_t    _temperaturePeriod;
+    uint32_t    _temperatureUpdate; // monotonic time of the next update
+
+    // Aging correction (ppb) at the last synchronization and its rate
+    // (ppb/year)
+    int32_t     _agingBase;
+    int32_t     _agingRate;
+    bool        _agingFitted;
+
+    // PPS discipline: edges counted and phase (ticks) captured by interrupt
+    Pps_State   _ppsState;
+    Pps_Input   _ppsInput;
+    volatile uint32_t _ppsCount;
+    volatile int32_t _ppsTicks;
+    uint32_t    _ppsTicksPerSecond;
+    uint32_t    _ppsProcessed;   // edge count already processed
+    uint32_t    _ppsLastEdge;    // millis() of the last edge processed
+    uint32_t    _ppsWindow;      // averaging window in seconds
+    uint32_t    _ppsWindowStart; // edge count at the start of the window
+    // Linear fit of the unshifted phase (ns) and mean calibration over the window
+    uint32_t    _ppsSamples;
+    int64_t     _ppsSumX;
+    int64_t     _ppsSumY;
+    int64_t     _ppsSumXX;
+    int64_t     _ppsSumXY;
+    int64_t     _ppsSumCalibration;
+    int32_t     _ppsPhase;       // ns
+    int32_t     _ppsFrequency;   // ppb
+    int32_t     _ppsShifted;     // ticks shifted since the start of the window
+    int32_t     _ppsCorrection;  // ppb
+
+    tamperFuncPtr _tamperCallbacks[RTC_TAMPER_COUNT];
+    void        *_tamperCallbacksData[RTC_TAMPER_COUNT];
+
     void configForLowPower(Source_Clock source);
 
     void syncTime(void);
     void syncDate(void);
     void syncAlarmTime(void);
 
+    void writeTime(void);
+    void writeDate(void);
+    void writeCalendar(bool date, bool time);
+    void setTimeOfDay(uint8_t hours, uint8_t minutes, uint8_t seconds);
+    void setAlarmTimeOfDay(uint8_t hours, uint8_t minutes, uint8_t seconds);
+    void startAlarm(void);
+    void startAlarmEpoch(uint32_t ts, Alarm_Match match);
+    void loadAlarmCache(void);
+    void updateAlarmCallback(void);
+    void armWeeklySchedule(void);
+    uint32_t nextWeeklyAlarm(uint32_t now);
+
+    uint32_t nextAlarmEpoch(uint32_t now);
+    void recordAlarmTarget(void);
+    void checkMissedAlarm(void);
+    void deliverMissedAlarm(void);
+
+    void processAlarmQueue(void);
+
+    int32_t temperatureCorrection(int32_t temperature);
+    bool applyCalibration(void);
+    int32_t agingCorrection(uint32_t now);
+    void fitAging(uint32_t now, uint32_t accuracy, int32_t offset);
+    void storeAging(void);
+#if defined(RTC_SYNCHRO_SHIFT)
+    bool ppsMeasure(uint32_t count, int32_t ticks);
+    void ppsRestartWindow(uint32_t count);
+#endif /* RTC_SYNCHRO_SHIFT */
+
+    static void alarmDispatch(void *data);
+#if defined(RTC_SYNC_ALARM)
+    static void syncDispatch(void *data);
+#endif /* RTC_SYNC_ALARM */
+#if defined(RTC_TAMPER_IRQn)
+    static void tamperDispatch(uint8_t tamper, void *data);
+#endif /* RTC_TAMPER_IRQn */
+#if defined(RTC_TIMESTAMP_IT)
+    static void ppsDispatch(void *data);
+#endif /* RTC_TIMESTAMP_IT */
+#ifdef ONESECOND_IRQn
+    void updateSecondsCallback(void);
+    static void secondsDispatch(void *data);
+#endif /* ONESECOND_IRQn */
+
 };
 
 #endif // __STM32_RTC_H
@@ -36,6 +36,9 @@
 
 #include "rtc.h"
 #include "stm32yyxx_ll_rtc.h"
+#if defined(BKPSRAM_BASE)
+#include "stm32yyxx_ll_pwr.h"
+#endif
 #include <string.h>
 
 #if defined(STM32_CORE_VERSION) && (STM32_CORE_VERSION  > 0x01090000) &&\
@@ -61,6 +64,18 @@ static RTC_HandleTypeDef RtcHandle = {0};
 static voidCallbackPtr RTCUserCallback = NULL;
 static void *callbackUserData = NULL;
 static voidCallbackPtr RTCSecondsIrqCallback = NULL;
+#if defined(RTC_SYNC_ALARM)
+static voidCallbackPtr RTCAlarmBCallback = NULL;
+static void *alarmBCallbackData = NULL;
+#endif /* RTC_SYNC_ALARM */
+#if defined(RTC_TAMPER_IRQn)
+static tamperCallbackPtr RTCTamperCallback = NULL;
+static void *tamperCallbackData = NULL;
+#endif /* RTC_TAMPER_IRQn */
+#if defined(RTC_TIMESTAMP_IT)
+static voidCallbackPtr RTCTimeStampCallback = NULL;
+static void *timeStampCallbackData = NULL;
+#endif /* RTC_TIMESTAMP_IT */
 
 static sourceClock_t clkSrc = LSI_CLOCK;
 static uint8_t HSEDiv = 0;
@@ -75,6 +90,18 @@ static uint32_t prediv = RTC_AUTO_1_SECOND;
 
 static hourFormat_t initFormat = HOUR_FORMAT_12;
 
+#if !defined(STM32F1xx)
+/* Shadow of the last ALRMAR/ALRMASSR words programmed for Alarm A */
+static uint32_t alarmShadowAR = 0;
+static uint32_t alarmShadowASSR = 0;
+static bool alarmShadowValid = false;
+/* Alarm A interrupt line configured by the HAL since the initialization */
+static bool alarmHalConfigured = false;
+#endif /* !STM32F1xx */
+/* Alarm A programming statistics */
+static uint32_t alarmWriteCount = 0;
+static uint32_t alarmSkipCount = 0;
+
 /* Private function prototypes -----------------------------------------------*/
 static void RTC_initClock(sourceClock_t source);
 #if !defined(STM32F1xx)
@@ -327,6 +354,7 @@ static void RTC_computePrediv(int8_t *asynch, int16_t *synch)
   }
   *synch = (int16_t)predivS;
 }
+
 #endif /* !STM32F1xx */
 
 /**
@@ -344,6 +372,10 @@ bool RTC_init(hourFormat_t format, sourceClock_t source, bool reset)
   bool reinit = false;
 
   initFormat = format;
+#if !defined(STM32F1xx)
+  alarmShadowValid = false;
+  alarmHalConfigured = false;
+#endif /* !STM32F1xx */
 
   /* Init RTC clock */
   RTC_initClock(source);
@@ -398,6 +430,8 @@ bool RTC_init(hourFormat_t format, sourceClock_t source, bool reset)
   } else {
     // This initialize variables: predivAsync, redivSync and predivSync_bits
     RTC_getPrediv(NULL, NULL);
+    // Keep the hour format the RTC has been configured with
+    initFormat = (LL_RTC_GetHourFormat(RtcHandle.Instance) == LL_RTC_HOURFORMAT_AMPM) ? HOUR_FORMAT_12 : HOUR_FORMAT_24;
   }
 #endif /* STM32F1xx */
 
@@ -406,6 +440,26 @@ bool RTC_init(hourFormat_t format, sourceClock_t source, bool reset)
   HAL_RTCEx_EnableBypassShadow(&RtcHandle);
 #endif
 
+  if (!reinit && RTC_IsAlarmSet()) {
+    /* The alarm A stays armed across a reset of the MCU, but not its
+       interrupt line: enable it again so that the alarm is delivered.
+       A match latched before the reset is cleared first, so that it is not
+       delivered as a new occurrence (begin() reports it as a missed alarm) */
+    __HAL_RTC_ALARM_CLEAR_FLAG(&RtcHandle, RTC_FLAG_ALRAF);
+#if defined(__HAL_RTC_ALARM_EXTI_CLEAR_FLAG)
+    __HAL_RTC_ALARM_EXTI_CLEAR_FLAG();
+#endif
+    HAL_NVIC_ClearPendingIRQ(RTC_Alarm_IRQn);
+#if defined(__HAL_RTC_ALARM_EXTI_ENABLE_IT)
+    __HAL_RTC_ALARM_EXTI_ENABLE_IT();
+#endif
+#if defined(__HAL_RTC_ALARM_EXTI_ENABLE_RISING_EDGE)
+    __HAL_RTC_ALARM_EXTI_ENABLE_RISING_EDGE();
+#endif
+    HAL_NVIC_SetPriority(RTC_Alarm_IRQn, RTC_IRQ_PRIO, RTC_IRQ_SUBPRIO);
+    HAL_NVIC_EnableIRQ(RTC_Alarm_IRQn);
+  }
+
   return reinit;
 }
 
@@ -416,9 +470,118 @@ bool RTC_init(hourFormat_t format, sourceClock_t source, bool reset)
 void RTC_DeInit(void)
 {
   HAL_RTC_DeInit(&RtcHandle);
+#if !defined(STM32F1xx)
+  alarmShadowValid = false;
+#endif /* !STM32F1xx */
   RTCUserCallback = NULL;
   callbackUserData = NULL;
   RTCSecondsIrqCallback = NULL;
+#if defined(RTC_SYNC_ALARM)
+  RTCAlarmBCallback = NULL;
+  alarmBCallbackData = NULL;
+#endif /* RTC_SYNC_ALARM */
+#if defined(RTC_TAMPER_IRQn)
+  RTCTamperCallback = NULL;
+  tamperCallbackData = NULL;
+#endif /* RTC_TAMPER_IRQn */
+#if defined(RTC_TIMESTAMP_IT)
+  RTCTimeStampCallback = NULL;
+  timeStampCallbackData = NULL;
+#endif /* RTC_TIMESTAMP_IT */
+}
+
+/**
+  * @brief Get and clear the RTC and PWR flags telling why the device woke up
+  * @note  Can be called before RTC_init(): only the flags are accessed.
+  *        The flags are read and cleared with interrupts disabled.
+  * @retval combination of RTC_WAKE_* flags, RTC_WAKE_NONE if none is set
+  */
+uint32_t RTC_GetWakeReason(void)
+{
+  uint32_t reason = RTC_WAKE_NONE;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  RtcHandle.Instance = RTC;
+  /* Flags can't be cleared without backup domain access */
+  enableBackupDomain();
+
+  if (__HAL_RTC_ALARM_GET_FLAG(&RtcHandle, RTC_FLAG_ALRAF)) {
+    __HAL_RTC_ALARM_CLEAR_FLAG(&RtcHandle, RTC_FLAG_ALRAF);
+    reason |= RTC_WAKE_ALARM_A;
+  }
+#if defined(RTC_FLAG_ALRBF)
+  if (__HAL_RTC_ALARM_GET_FLAG(&RtcHandle, RTC_FLAG_ALRBF)) {
+    __HAL_RTC_ALARM_CLEAR_FLAG(&RtcHandle, RTC_FLAG_ALRBF);
+    reason |= RTC_WAKE_ALARM_B;
+  }
+#endif /* RTC_FLAG_ALRBF */
+#if defined(RTC_FLAG_WUTF)
+  if (__HAL_RTC_WAKEUPTIMER_GET_FLAG(&RtcHandle, RTC_FLAG_WUTF)) {
+    __HAL_RTC_WAKEUPTIMER_CLEAR_FLAG(&RtcHandle, RTC_FLAG_WUTF);
+    reason |= RTC_WAKE_TIMER;
+  }
+#endif /* RTC_FLAG_WUTF */
+#if defined(RTC_FLAG_TSF)
+  if (__HAL_RTC_TIMESTAMP_GET_FLAG(&RtcHandle, RTC_FLAG_TSF)) {
+    /* The time stamp registers are kept until the next event */
+    __HAL_RTC_TIMESTAMP_CLEAR_FLAG(&RtcHandle, RTC_FLAG_TSF);
+    reason |= RTC_WAKE_TIMESTAMP;
+  }
+#endif /* RTC_FLAG_TSF */
+#if defined(RTC_FLAG_TAMP1F)
+  if (__HAL_RTC_TAMPER_GET_FLAG(&RtcHandle, RTC_FLAG_TAMP1F)) {
+    __HAL_RTC_TAMPER_CLEAR_FLAG(&RtcHandle, RTC_FLAG_TAMP1F);
+    reason |= RTC_WAKE_TAMPER;
+  }
+#if defined(RTC_FLAG_TAMP2F)
+  if (__HAL_RTC_TAMPER_GET_FLAG(&RtcHandle, RTC_FLAG_TAMP2F)) {
+    __HAL_RTC_TAMPER_CLEAR_FLAG(&RtcHandle, RTC_FLAG_TAMP2F);
+    reason |= RTC_WAKE_TAMPER;
+  }
+#endif /* RTC_FLAG_TAMP2F */
+#if defined(RTC_FLAG_TAMP3F)
+  if (__HAL_RTC_TAMPER_GET_FLAG(&RtcHandle, RTC_FLAG_TAMP3F)) {
+    __HAL_RTC_TAMPER_CLEAR_FLAG(&RtcHandle, RTC_FLAG_TAMP3F);
+    reason |= RTC_WAKE_TAMPER;
+  }
+#endif /* RTC_FLAG_TAMP3F */
+#elif defined(RTC_FLAG_TAMP1)
+  /* Tamper flags in the TAMP peripheral */
+  if (__HAL_RTC_TAMPER_GET_FLAG(&RtcHandle, RTC_FLAG_TAMP1)) {
+    __HAL_RTC_TAMPER_CLEAR_FLAG(&RtcHandle, RTC_FLAG_TAMP1);
+    reason |= RTC_WAKE_TAMPER;
+  }
+#if defined(RTC_FLAG_TAMP2)
+  if (__HAL_RTC_TAMPER_GET_FLAG(&RtcHandle, RTC_FLAG_TAMP2)) {
+    __HAL_RTC_TAMPER_CLEAR_FLAG(&RtcHandle, RTC_FLAG_TAMP2);
+    reason |= RTC_WAKE_TAMPER;
+  }
+#endif /* RTC_FLAG_TAMP2 */
+#endif /* RTC_FLAG_TAMP1F */
+#if defined(HAL_PWR_MODULE_ENABLED) && defined(PWR_FLAG_SB)
+  if (__HAL_PWR_GET_FLAG(PWR_FLAG_SB)) {
+    __HAL_PWR_CLEAR_FLAG(PWR_FLAG_SB);
+    reason |= RTC_WAKE_STANDBY;
+  }
+#endif /* HAL_PWR_MODULE_ENABLED && PWR_FLAG_SB */
+
+  __set_PRIMASK(primask);
+  return reason;
+}
+
+/**
+  * @brief Get the hour format the RTC is configured with
+  * @retval HOUR_FORMAT_12 or HOUR_FORMAT_24
+  */
+hourFormat_t RTC_GetHourFormat(void)
+{
+#if defined(STM32F1xx)
+  /* F1 doesn't manage 12h format */
+  return HOUR_FORMAT_24;
+#else
+  return initFormat;
+#endif /* STM32F1xx */
 }
 
 /**
@@ -580,70 +743,191 @@ void RTC_GetDate(uint8_t *year, uint8_t *month, uint8_t *day, uint8_t *wday)
 }
 
 /**
-  * @brief Set RTC alarm and activate it with IT mode
-  * @param day: 1-31 (day of the month)
-  * @param hours: 0-12 or 0-23 depends on the hours mode.
-  * @param minutes: 0-59
-  * @param seconds: 0-59
-  * @param subSeconds: 0-999
-  * @param period: HOUR_AM or HOUR_PM if in 12 hours mode else ignored.
-  * @param mask: configure alarm behavior using alarmMask_t combination.
-  *              See AN4579 Table 5 for possible values.
+  * @brief Get RTC raw calendar date
+  * @note  The returned value only changes when the date changes. It can be
+  *        used as a key to detect a date change without decoding it.
+  * @retval DR register content or the packed date for STM32F1xx
+  */
+uint32_t RTC_GetRawDate(void)
+{
+#if defined(STM32F1xx)
+  uint32_t rawDate;
+  memcpy(&rawDate, &RtcHandle.DateToUpdate, 4);
+  return rawDate;
+#else
+  return READ_REG(RtcHandle.Instance->DR);
+#endif /* STM32F1xx */
+}
+
+/**
+  * @brief Decode a raw date returned by RTC_GetRawDate()
+  * @param rawDate: raw date
+  * @param year: 0-99
+  * @param month: 1-12
+  * @param day: 1-31
   * @retval None
   */
-void RTC_StartAlarm(uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+void RTC_DecodeRawDate(uint32_t rawDate, uint8_t *year, uint8_t *month, uint8_t *day)
 {
-  RTC_AlarmTypeDef RTC_AlarmStructure;
+#if defined(STM32F1xx)
+  RTC_DateTypeDef date;
+  memcpy(&date, &rawDate, 4);
+  *year = date.Year;
+  *month = date.Month;
+  *day = date.Date;
+#else
+  *year = __LL_RTC_CONVERT_BCD2BIN((rawDate & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos);
+  *month = __LL_RTC_CONVERT_BCD2BIN((rawDate & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos);
+  *day = __LL_RTC_CONVERT_BCD2BIN((rawDate & (RTC_DR_DT | RTC_DR_DU)) >> RTC_DR_DU_Pos);
+#endif /* STM32F1xx */
+}
 
+/**
+  * @brief Get a coherent snapshot of the raw time registers
+  * @note  No conversion is done, the snapshot is meant to be compared to
+  *        another one with RTC_DecodeRawTime() and RTC_DecodeRawDate().
+  * @param raw: time, date and subseconds registers (seconds counter, packed
+  *             date and divider for STM32F1xx)
+  * @retval None
+  */
+void RTC_GetRawTime(rawTime_t *raw)
+{
+  uint32_t time;
+
+#if defined(STM32F1xx)
+  /* Read the counter again if it changed while reading the divider */
+  do {
+    time = (READ_REG(RtcHandle.Instance->CNTH) << 16) | READ_REG(RtcHandle.Instance->CNTL);
+    raw->subSeconds = ((READ_REG(RtcHandle.Instance->DIVH) & RTC_DIVH_RTC_DIV) << 16) |
+                      READ_REG(RtcHandle.Instance->DIVL);
+    raw->time = (READ_REG(RtcHandle.Instance->CNTH) << 16) | READ_REG(RtcHandle.Instance->CNTL);
+  } while (raw->time != time);
+  raw->date = RTC_GetRawDate();
+#else
+  /* Registers are read directly (bypass shadow): read the time again if a
+     second elapsed during the snapshot */
+  do {
+    time = READ_REG(RtcHandle.Instance->TR);
+#if defined(RTC_SSR_SS)
+    raw->subSeconds = READ_REG(RtcHandle.Instance->SSR) & RTC_SSR_SS;
+#else
+    raw->subSeconds = 0;
+#endif /* RTC_SSR_SS */
+    raw->date = READ_REG(RtcHandle.Instance->DR);
+    raw->time = READ_REG(RtcHandle.Instance->TR);
+  } while (raw->time != time);
+#endif /* STM32F1xx */
+}
+
+/**
+  * @brief Get the number of RTC ticks in one second
+  * @retval number of ticks, 1 if the subseconds are not available
+  */
+uint32_t RTC_GetTicksPerSecond(void)
+{
+#if defined(STM32F1xx)
+  return (((READ_REG(RtcHandle.Instance->PRLH) & RTC_PRLH_PRL) << 16) |
+          READ_REG(RtcHandle.Instance->PRLL)) + 1;
+#elif defined(RTC_SSR_SS)
+  return predivSync + 1;
+#else
+  return 1;
+#endif /* STM32F1xx */
+}
+
+/**
+  * @brief Decode the time of a raw snapshot returned by RTC_GetRawTime()
+  * @param raw: raw snapshot
+  * @param seconds: seconds since the beginning of the day (seconds counter
+  *                 for STM32F1xx)
+  * @param ticks: ticks elapsed in the second. Can be negative or greater than
+  *               one second after a shift operation.
+  * @retval None
+  */
+void RTC_DecodeRawTime(const rawTime_t *raw, uint32_t *seconds, int32_t *ticks)
+{
+  uint32_t predivS = RTC_GetTicksPerSecond() - 1;
+
+#if defined(STM32F1xx)
+  *seconds = raw->time;
+#else
+  uint32_t hours = __LL_RTC_CONVERT_BCD2BIN((raw->time & (RTC_TR_HT | RTC_TR_HU)) >> RTC_TR_HU_Pos);
+  if (initFormat == HOUR_FORMAT_12) {
+    hours = (hours % 12) + ((raw->time & RTC_TR_PM) ? 12 : 0);
+  }
+  *seconds = (hours * 3600) +
+             (__LL_RTC_CONVERT_BCD2BIN((raw->time & (RTC_TR_MNT | RTC_TR_MNU)) >> RTC_TR_MNU_Pos) * 60) +
+             __LL_RTC_CONVERT_BCD2BIN((raw->time & (RTC_TR_ST | RTC_TR_SU)) >> RTC_TR_SU_Pos);
+#endif /* STM32F1xx */
+  /* The subseconds register counts down, it exceeds the prescaler after a
+     negative shift */
+  *ticks = (int32_t)predivS - (int32_t)raw->subSeconds;
+}
+
+/**
+  * @brief Fill the HAL alarm structure
+  * @param RTC_AlarmStructure: structure to fill
+  * @param alarm: RTC_ALARM_A or RTC_ALARM_B
+  * @param day, hours, minutes, seconds, subSeconds, period, mask:
+  *        see RTC_StartAlarm()
+  * @retval true if the alarm parameters are valid
+  */
+static bool RTC_BuildAlarm(RTC_AlarmTypeDef *RTC_AlarmStructure, uint32_t alarm, uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+{
   /* Ignore time AM PM configuration if in 24 hours format */
   if (initFormat == HOUR_FORMAT_24) {
     period = HOUR_AM;
   }
 
   if ((((initFormat == HOUR_FORMAT_24) && IS_RTC_HOUR24(hours)) || IS_RTC_HOUR12(hours))
-      && IS_RTC_DATE(day) && IS_RTC_MINUTES(minutes) && IS_RTC_SECONDS(seconds)) {
+      && (((mask & WD_MSK) && IS_RTC_WEEKDAY(day)) || (!(mask & WD_MSK) && IS_RTC_DATE(day)))
+      && IS_RTC_MINUTES(minutes) && IS_RTC_SECONDS(seconds)) {
     /* Set RTC_AlarmStructure with calculated values*/
-    /* Use alarm A by default because it is common to all STM32 HAL */
-    RTC_AlarmStructure.Alarm = RTC_ALARM_A;
-    RTC_AlarmStructure.AlarmTime.Seconds = seconds;
-    RTC_AlarmStructure.AlarmTime.Minutes = minutes;
-    RTC_AlarmStructure.AlarmTime.Hours = hours;
+    RTC_AlarmStructure->Alarm = alarm;
+    RTC_AlarmStructure->AlarmTime.Seconds = seconds;
+    RTC_AlarmStructure->AlarmTime.Minutes = minutes;
+    RTC_AlarmStructure->AlarmTime.Hours = hours;
 #if !defined(STM32F1xx)
 #if defined(RTC_SSR_SS)
     if (subSeconds < 1000) {
-      RTC_AlarmStructure.AlarmSubSecondMask = predivSync_bits << RTC_ALRMASSR_MASKSS_Pos;
-      RTC_AlarmStructure.AlarmTime.SubSeconds = predivSync - (subSeconds * (predivSync + 1)) / 1000;
+      RTC_AlarmStructure->AlarmSubSecondMask = predivSync_bits << RTC_ALRMASSR_MASKSS_Pos;
+      RTC_AlarmStructure->AlarmTime.SubSeconds = predivSync - (subSeconds * (predivSync + 1)) / 1000;
     } else {
-      RTC_AlarmStructure.AlarmSubSecondMask = RTC_ALARMSUBSECONDMASK_ALL;
+      RTC_AlarmStructure->AlarmSubSecondMask = RTC_ALARMSUBSECONDMASK_ALL;
+      RTC_AlarmStructure->AlarmTime.SubSeconds = 0;
     }
 #else
     UNUSED(subSeconds);
 #endif /* RTC_SSR_SS */
     if (period == HOUR_PM) {
-      RTC_AlarmStructure.AlarmTime.TimeFormat = RTC_HOURFORMAT12_PM;
+      RTC_AlarmStructure->AlarmTime.TimeFormat = RTC_HOURFORMAT12_PM;
+    } else {
+      RTC_AlarmStructure->AlarmTime.TimeFormat = RTC_HOURFORMAT12_AM;
+    }
+    RTC_AlarmStructure->AlarmTime.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
+    RTC_AlarmStructure->AlarmTime.StoreOperation = RTC_STOREOPERATION_RESET;
+    RTC_AlarmStructure->AlarmDateWeekDay = day;
+    if (mask & WD_MSK) {
+      RTC_AlarmStructure->AlarmDateWeekDaySel = RTC_ALARMDATEWEEKDAYSEL_WEEKDAY;
     } else {
-      RTC_AlarmStructure.AlarmTime.TimeFormat = RTC_HOURFORMAT12_AM;
+      RTC_AlarmStructure->AlarmDateWeekDaySel = RTC_ALARMDATEWEEKDAYSEL_DATE;
     }
-    RTC_AlarmStructure.AlarmTime.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
-    RTC_AlarmStructure.AlarmTime.StoreOperation = RTC_STOREOPERATION_RESET;
-    RTC_AlarmStructure.AlarmDateWeekDay = day;
-    RTC_AlarmStructure.AlarmDateWeekDaySel = RTC_ALARMDATEWEEKDAYSEL_DATE;
-    /* configure AlarmMask (M_MSK and Y_MSK ignored) */
+    /* configure AlarmMask (M_MSK and Y_MSK ignored, WD_MSK handled above) */
     if (mask == OFF_MSK) {
-      RTC_AlarmStructure.AlarmMask = RTC_ALARMMASK_ALL;
+      RTC_AlarmStructure->AlarmMask = RTC_ALARMMASK_ALL;
     } else {
-      RTC_AlarmStructure.AlarmMask = RTC_ALARMMASK_NONE;
+      RTC_AlarmStructure->AlarmMask = RTC_ALARMMASK_NONE;
       if (!(mask & SS_MSK)) {
-        RTC_AlarmStructure.AlarmMask |= RTC_ALARMMASK_SECONDS;
+        RTC_AlarmStructure->AlarmMask |= RTC_ALARMMASK_SECONDS;
       }
       if (!(mask & MM_MSK)) {
-        RTC_AlarmStructure.AlarmMask |= RTC_ALARMMASK_MINUTES;
+        RTC_AlarmStructure->AlarmMask |= RTC_ALARMMASK_MINUTES;
       }
       if (!(mask & HH_MSK)) {
-        RTC_AlarmStructure.AlarmMask |= RTC_ALARMMASK_HOURS;
+        RTC_AlarmStructure->AlarmMask |= RTC_ALARMMASK_HOURS;
       }
       if (!(mask & D_MSK)) {
-        RTC_AlarmStructure.AlarmMask |= RTC_ALARMMASK_DATEWEEKDAY;
+        RTC_AlarmStructure->AlarmMask |= RTC_ALARMMASK_DATEWEEKDAY;
       }
     }
 #else
@@ -652,14 +936,164 @@ void RTC_StartAlarm(uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds
     UNUSED(day);
     UNUSED(mask);
 #endif /* !STM32F1xx */
+    return true;
+  }
+  return false;
+}
 
+/**
+  * @brief Set RTC alarm and activate it with IT mode
+  * @param day: 1-31 (day of the month) or 1-7 (day of the week) if WD_MSK is set
+  * @param hours: 0-12 or 0-23 depends on the hours mode.
+  * @param minutes: 0-59
+  * @param seconds: 0-59
+  * @param subSeconds: 0-999
+  * @param period: HOUR_AM or HOUR_PM if in 12 hours mode else ignored.
+  * @param mask: configure alarm behavior using alarmMask_t combination.
+  *              See AN4579 Table 5 for possible values.
+  * @retval None
+  */
+void RTC_StartAlarm(uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+{
+  RTC_AlarmTypeDef RTC_AlarmStructure;
+#if !defined(STM32F1xx)
+  alarmRegs_t regs;
+
+  if (!RTC_BuildAlarmRegs(&regs, day, hours, minutes, seconds, subSeconds, period, mask)) {
+    return;
+  }
+  if (RTC_StartAlarmRegs(&regs)) {
+    return;
+  }
+#endif /* !STM32F1xx */
+
+  /* Use alarm A by default because it is common to all STM32 HAL */
+  if (RTC_BuildAlarm(&RTC_AlarmStructure, RTC_ALARM_A, day, hours, minutes, seconds, subSeconds, period, mask)) {
     /* Set RTC_Alarm */
     HAL_RTC_SetAlarm_IT(&RtcHandle, &RTC_AlarmStructure, RTC_FORMAT_BIN);
     HAL_NVIC_SetPriority(RTC_Alarm_IRQn, RTC_IRQ_PRIO, RTC_IRQ_SUBPRIO);
     HAL_NVIC_EnableIRQ(RTC_Alarm_IRQn);
+#if !defined(STM32F1xx)
+    alarmShadowAR = regs.alrmar;
+    alarmShadowASSR = regs.alrmassr;
+    alarmShadowValid = true;
+    alarmHalConfigured = true;
+#endif /* !STM32F1xx */
+    alarmWriteCount++;
   }
 }
 
+#if !defined(STM32F1xx)
+/**
+  * @brief Compute the ALRMAR and ALRMASSR register words of an alarm A
+  * @note  The words depend on the hour format and the prescaler: they must
+  *        be computed again after RTC_init() or RTC_setPrediv().
+  * @param regs: register words to fill
+  * @param day, hours, minutes, seconds, subSeconds, period, mask:
+  *        see RTC_StartAlarm()
+  * @retval true if the alarm parameters are valid
+  */
+bool RTC_BuildAlarmRegs(alarmRegs_t *regs, uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+{
+  if (!((((initFormat == HOUR_FORMAT_24) && IS_RTC_HOUR24(hours)) || IS_RTC_HOUR12(hours))
+        && (((mask & WD_MSK) && IS_RTC_WEEKDAY(day)) || (!(mask & WD_MSK) && IS_RTC_DATE(day)))
+        && IS_RTC_MINUTES(minutes) && IS_RTC_SECONDS(seconds))) {
+    return false;
+  }
+
+  regs->alrmar = ((uint32_t)__LL_RTC_CONVERT_BIN2BCD(day) << RTC_ALRMAR_DU_Pos) |
+                 ((uint32_t)__LL_RTC_CONVERT_BIN2BCD(hours) << RTC_ALRMAR_HU_Pos) |
+                 ((uint32_t)__LL_RTC_CONVERT_BIN2BCD(minutes) << RTC_ALRMAR_MNU_Pos) |
+                 ((uint32_t)__LL_RTC_CONVERT_BIN2BCD(seconds) << RTC_ALRMAR_SU_Pos);
+  /* Ignore time AM PM configuration if in 24 hours format */
+  if ((initFormat == HOUR_FORMAT_12) && (period == HOUR_PM)) {
+    regs->alrmar |= RTC_ALRMAR_PM;
+  }
+  if (mask & WD_MSK) {
+    regs->alrmar |= RTC_ALRMAR_WDSEL;
+  }
+  /* M_MSK and Y_MSK ignored, OFF_MSK masks all the fields */
+  if (!(mask & SS_MSK)) {
+    regs->alrmar |= RTC_ALRMAR_MSK1;
+  }
+  if (!(mask & MM_MSK)) {
+    regs->alrmar |= RTC_ALRMAR_MSK2;
+  }
+  if (!(mask & HH_MSK)) {
+    regs->alrmar |= RTC_ALRMAR_MSK3;
+  }
+  if (!(mask & D_MSK)) {
+    regs->alrmar |= RTC_ALRMAR_MSK4;
+  }
+#if defined(RTC_SSR_SS)
+  if (subSeconds < 1000) {
+    regs->alrmassr = ((uint32_t)predivSync_bits << RTC_ALRMASSR_MASKSS_Pos) |
+                     (predivSync - (subSeconds * (predivSync + 1)) / 1000);
+  } else {
+    regs->alrmassr = RTC_ALARMSUBSECONDMASK_ALL;
+  }
+#else
+  UNUSED(subSeconds);
+  regs->alrmassr = 0;
+#endif /* RTC_SSR_SS */
+  return true;
+}
+
+/**
+  * @brief Arm the alarm A from its precomputed register words
+  * @note  Only the alarm registers are written: disable, two writes and
+  *        enable. The alarm interrupt line must have been configured by a
+  *        first RTC_StartAlarm() since RTC_init().
+  * @param regs: register words computed by RTC_BuildAlarmRegs()
+  * @retval false if the alarm is not armed: it must be configured by
+  *         RTC_StartAlarm()
+  */
+bool RTC_StartAlarmRegs(const alarmRegs_t *regs)
+{
+  /* Skip the whole disable/wait/write/enable sequence if the alarm is
+     already running with the same register content */
+  if (alarmShadowValid && (regs->alrmar == alarmShadowAR) && (regs->alrmassr == alarmShadowASSR)
+      && (READ_BIT(RtcHandle.Instance->CR, RTC_CR_ALRAE | RTC_CR_ALRAIE) == (RTC_CR_ALRAE | RTC_CR_ALRAIE))) {
+    alarmSkipCount++;
+    return true;
+  }
+  if (!alarmHalConfigured) {
+    return false;
+  }
+
+  LL_RTC_DisableWriteProtection(RtcHandle.Instance);
+  CLEAR_BIT(RtcHandle.Instance->CR, RTC_CR_ALRAE | RTC_CR_ALRAIE);
+#if defined(RTC_ISR_ALRAWF) || defined(RTC_ICSR_ALRAWF)
+  uint32_t tickstart = HAL_GetTick();
+#if defined(RTC_ISR_ALRAWF)
+  while (READ_BIT(RtcHandle.Instance->ISR, RTC_ISR_ALRAWF) == 0U) {
+#else
+  while (READ_BIT(RtcHandle.Instance->ICSR, RTC_ICSR_ALRAWF) == 0U) {
+#endif
+    if ((HAL_GetTick() - tickstart) > RTC_TIMEOUT_VALUE) {
+      /* Let the HAL handle the error */
+      LL_RTC_EnableWriteProtection(RtcHandle.Instance);
+      alarmShadowValid = false;
+      return false;
+    }
+  }
+#endif /* RTC_ISR_ALRAWF || RTC_ICSR_ALRAWF */
+  WRITE_REG(RtcHandle.Instance->ALRMAR, regs->alrmar);
+#if defined(RTC_SSR_SS)
+  WRITE_REG(RtcHandle.Instance->ALRMASSR, regs->alrmassr);
+#endif /* RTC_SSR_SS */
+  __HAL_RTC_ALARM_CLEAR_FLAG(&RtcHandle, RTC_FLAG_ALRAF);
+  SET_BIT(RtcHandle.Instance->CR, RTC_CR_ALRAE | RTC_CR_ALRAIE);
+  LL_RTC_EnableWriteProtection(RtcHandle.Instance);
+
+  alarmShadowAR = regs->alrmar;
+  alarmShadowASSR = regs->alrmassr;
+  alarmShadowValid = true;
+  alarmWriteCount++;
+  return true;
+}
+#endif /* !STM32F1xx */
+
 /**
   * @brief Disable RTC alarm
   * @param None
@@ -672,6 +1106,604 @@ void RTC_StopAlarm(void)
 
   /* Disable the Alarm A interrupt */
   HAL_RTC_DeactivateAlarm(&RtcHandle, RTC_ALARM_A);
+#if !defined(STM32F1xx)
+  alarmShadowValid = false;
+#endif /* !STM32F1xx */
+}
+
+#if defined(RTC_SYNC_ALARM)
+/**
+  * @brief Set RTC alarm B and activate it with IT mode
+  * @note  Alarm B is kept for the synchronized actions so that it never
+  *        conflicts with the alarm A used by RTC_StartAlarm().
+  * @param day, hours, minutes, seconds, subSeconds, period, mask:
+  *        see RTC_StartAlarm()
+  * @retval None
+  */
+void RTC_StartAlarmB(uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask)
+{
+  RTC_AlarmTypeDef RTC_AlarmStructure;
+
+  if (RTC_BuildAlarm(&RTC_AlarmStructure, RTC_ALARM_B, day, hours, minutes, seconds, subSeconds, period, mask)) {
+    HAL_RTC_SetAlarm_IT(&RtcHandle, &RTC_AlarmStructure, RTC_FORMAT_BIN);
+    HAL_NVIC_SetPriority(RTC_Alarm_IRQn, RTC_IRQ_PRIO, RTC_IRQ_SUBPRIO);
+    HAL_NVIC_EnableIRQ(RTC_Alarm_IRQn);
+  }
+}
+
+/**
+  * @brief Disable RTC alarm B
+  * @param None
+  * @retval None
+  */
+void RTC_StopAlarmB(void)
+{
+  __HAL_RTC_ALARM_CLEAR_FLAG(&RtcHandle, RTC_FLAG_ALRBF);
+  HAL_RTC_DeactivateAlarm(&RtcHandle, RTC_ALARM_B);
+}
+
+/**
+  * @brief Get the elapsed part of the current second in RTC ticks
+  * @param ticksPerSecond: number of ticks in one second (optional could be NULL)
+  * @retval number of ticks elapsed since the beginning of the second
+  */
+uint32_t RTC_GetSubSecondTicks(uint32_t *ticksPerSecond)
+{
+  if (ticksPerSecond != NULL) {
+    *ticksPerSecond = predivSync + 1;
+  }
+  return predivSync - LL_RTC_TIME_GetSubSecond(RtcHandle.Instance);
+}
+
+/**
+  * @brief Attach alarm B callback.
+  * @param func: pointer to the callback
+  * @param data: user data passed to the callback
+  * @retval None
+  */
+void attachAlarmBCallback(voidCallbackPtr func, void *data)
+{
+  RTCAlarmBCallback = func;
+  alarmBCallbackData = data;
+}
+
+/**
+  * @brief Detach alarm B callback.
+  * @param None
+  * @retval None
+  */
+void detachAlarmBCallback(void)
+{
+  RTCAlarmBCallback = NULL;
+  alarmBCallbackData = NULL;
+}
+
+/**
+  * @brief  Alarm B callback.
+  * @param  hrtc RTC handle
+  * @retval None
+  */
+void HAL_RTCEx_AlarmBEventCallback(RTC_HandleTypeDef *hrtc)
+{
+  UNUSED(hrtc);
+
+  if (RTCAlarmBCallback != NULL) {
+    RTCAlarmBCallback(alarmBCallbackData);
+  }
+}
+#endif /* RTC_SYNC_ALARM */
+
+/**
+  * @brief Get the RTC clock frequency
+  * @retval frequency in Hz of the RTC clock (RTCCLK)
+  */
+uint32_t RTC_GetClockFrequency(void)
+{
+#if defined(STM32F1xx)
+  return RTC_GetTicksPerSecond();
+#else
+  return (predivAsync + 1) * (predivSync + 1);
+#endif /* STM32F1xx */
+}
+
+/**
+  * @brief Set the RTC frequency correction
+  * @note  The correction is applied by adding or masking RTCCLK pulses in
+  *        each 2^20 pulses, so its resolution is 0.954 ppm. The range is
+  *        -487.1 to +488.5 ppm, -121 to 0 ppm for STM32F1xx.
+  * @param ppb: correction in ppb, positive to speed the RTC up
+  * @retval correction applied in ppb, 0 if the calibration is not available
+  */
+int32_t RTC_SetCalibration(int32_t ppb)
+{
+#if defined(RTC_SMOOTH_CALIB)
+  /* Number of pulses added in 2^20 pulses, rounded */
+  int64_t scaled = (int64_t)ppb * 1048576;
+  int32_t pulses = (int32_t)((scaled + ((scaled < 0) ? -500000000 : 500000000)) / 1000000000);
+
+#if defined(STM32F1xx)
+  if (pulses > 0) {
+    pulses = 0;
+  } else if (pulses < -(int32_t)BKP_RTCCR_CAL) {
+    pulses = -(int32_t)BKP_RTCCR_CAL;
+  }
+  HAL_RTCEx_SetSmoothCalib(&RtcHandle, 0, 0, (uint32_t)(-pulses));
+#else
+  if (pulses > 512) {
+    pulses = 512;
+  } else if (pulses < -(int32_t)RTC_CALR_CALM) {
+    pulses = -(int32_t)RTC_CALR_CALM;
+  }
+  /* CALP adds 512 pulses, CALM masks up to 511 pulses */
+  HAL_RTCEx_SetSmoothCalib(&RtcHandle, RTC_SMOOTHCALIB_PERIOD_32SEC,
+                           (pulses > 0) ? RTC_SMOOTHCALIB_PLUSPULSES_SET : RTC_SMOOTHCALIB_PLUSPULSES_RESET,
+                           (pulses > 0) ? (uint32_t)(512 - pulses) : (uint32_t)(-pulses));
+#endif /* STM32F1xx */
+  return RTC_GetCalibration();
+#else
+  UNUSED(ppb);
+  return 0;
+#endif /* RTC_SMOOTH_CALIB */
+}
+
+/**
+  * @brief Get the RTC frequency correction
+  * @retval correction in ppb, positive when the RTC is sped up
+  */
+int32_t RTC_GetCalibration(void)
+{
+#if defined(RTC_SMOOTH_CALIB)
+  int32_t pulses;
+
+#if defined(STM32F1xx)
+  pulses = -(int32_t)(READ_REG(BKP->RTCCR) & BKP_RTCCR_CAL);
+#else
+  uint32_t calr = READ_REG(RtcHandle.Instance->CALR);
+  pulses = ((calr & RTC_CALR_CALP) ? 512 : 0) - (int32_t)(calr & RTC_CALR_CALM);
+#endif /* STM32F1xx */
+  int64_t scaled = (int64_t)pulses * 1000000000;
+  return (int32_t)((scaled + ((scaled < 0) ? -524288 : 524288)) / 1048576);
+#else
+  return 0;
+#endif /* RTC_SMOOTH_CALIB */
+}
+
+#if defined(RTC_TAMPER_IRQn)
+/**
+  * @brief Configure a tamper input and enable its interrupt
+  * @param tamper: tamper input number (1-3 depending on the series)
+  * @param trigger: TAMPER_RISING_EDGE or TAMPER_FALLING_EDGE when filter is 0,
+  *                 TAMPER_LOW_LEVEL or TAMPER_HIGH_LEVEL else
+  * @param filter: 0 (edge detection), 2, 4 or 8 consecutive samples
+  *                (level detection)
+  * @param samplingDiv: RTCCLK divider of the level sampling: 256 to 32768
+  *                     (power of 2)
+  * @param precharge: 0 to disable the pull-up, else precharge duration in
+  *                   RTCCLK cycles: 1, 2, 4 or 8
+  * @param timeStamp: true to save a time stamp on tamper detection
+  * @param noErase: true to keep the backup registers on tamper detection
+  * @retval true if the configuration is supported
+  */
+bool RTC_EnableTamper(uint8_t tamper, tamperTrigger_t trigger, uint8_t filter, uint16_t samplingDiv, uint8_t precharge, bool timeStamp, bool noErase)
+{
+  RTC_TamperTypeDef sTamper = {0};
+  bool level = (trigger == TAMPER_LOW_LEVEL) || (trigger == TAMPER_HIGH_LEVEL);
+
+  switch (tamper) {
+    case 1:
+      sTamper.Tamper = RTC_TAMPER_1;
+      break;
+#if defined(RTC_TAMPER_2)
+    case 2:
+      sTamper.Tamper = RTC_TAMPER_2;
+      break;
+#endif
+#if defined(RTC_TAMPER_3)
+    case 3:
+      sTamper.Tamper = RTC_TAMPER_3;
+      break;
+#endif
+    default:
+      return false;
+  }
+  /* Edges are only detected without filter, levels with */
+  if (level != (filter != 0)) {
+    return false;
+  }
+#if !defined(RTC_TAMPERFILTER_DISABLE)
+  /* No filter, sampling nor precharge (STM32F2xx): edges without pull-up */
+  UNUSED(samplingDiv);
+  if (precharge != 0) {
+    return false;
+  }
+#endif /* !RTC_TAMPERFILTER_DISABLE */
+  switch (trigger) {
+    case TAMPER_RISING_EDGE:
+      sTamper.Trigger = RTC_TAMPERTRIGGER_RISINGEDGE;
+      break;
+    case TAMPER_FALLING_EDGE:
+      sTamper.Trigger = RTC_TAMPERTRIGGER_FALLINGEDGE;
+      break;
+#if defined(RTC_TAMPERFILTER_DISABLE)
+    case TAMPER_LOW_LEVEL:
+      sTamper.Trigger = RTC_TAMPERTRIGGER_LOWLEVEL;
+      break;
+    default:
+      sTamper.Trigger = RTC_TAMPERTRIGGER_HIGHLEVEL;
+      break;
+#else
+    default:
+      return false;
+#endif /* RTC_TAMPERFILTER_DISABLE */
+  }
+#if defined(RTC_TAMPERFILTER_DISABLE)
+  switch (filter) {
+    case 0:
+      sTamper.Filter = RTC_TAMPERFILTER_DISABLE;
+      break;
+    case 2:
+      sTamper.Filter = RTC_TAMPERFILTER_2SAMPLE;
+      break;
+    case 4:
+      sTamper.Filter = RTC_TAMPERFILTER_4SAMPLE;
+      break;
+    case 8:
+      sTamper.Filter = RTC_TAMPERFILTER_8SAMPLE;
+      break;
+    default:
+      return false;
+  }
+  switch (samplingDiv) {
+    case 256:
+      sTamper.SamplingFrequency = RTC_TAMPERSAMPLINGFREQ_RTCCLK_DIV256;
+      break;
+    case 512:
+      sTamper.SamplingFrequency = RTC_TAMPERSAMPLINGFREQ_RTCCLK_DIV512;
+      break;
+    case 1024:
+      sTamper.SamplingFrequency = RTC_TAMPERSAMPLINGFREQ_RTCCLK_DIV1024;
+      break;
+    case 2048:
+      sTamper.SamplingFrequency = RTC_TAMPERSAMPLINGFREQ_RTCCLK_DIV2048;
+      break;
+    case 4096:
+      sTamper.SamplingFrequency = RTC_TAMPERSAMPLINGFREQ_RTCCLK_DIV4096;
+      break;
+    case 8192:
+      sTamper.SamplingFrequency = RTC_TAMPERSAMPLINGFREQ_RTCCLK_DIV8192;
+      break;
+    case 16384:
+      sTamper.SamplingFrequency = RTC_TAMPERSAMPLINGFREQ_RTCCLK_DIV16384;
+      break;
+    case 32768:
+      sTamper.SamplingFrequency = RTC_TAMPERSAMPLINGFREQ_RTCCLK_DIV32768;
+      break;
+    default:
+      return false;
+  }
+  sTamper.TamperPullUp = RTC_TAMPER_PULLUP_ENABLE;
+  switch (precharge) {
+    case 0:
+      sTamper.TamperPullUp = RTC_TAMPER_PULLUP_DISABLE;
+      sTamper.PrechargeDuration = RTC_TAMPERPRECHARGEDURATION_1RTCCLK;
+      break;
+    case 1:
+      sTamper.PrechargeDuration = RTC_TAMPERPRECHARGEDURATION_1RTCCLK;
+      break;
+    case 2:
+      sTamper.PrechargeDuration = RTC_TAMPERPRECHARGEDURATION_2RTCCLK;
+      break;
+    case 4:
+      sTamper.PrechargeDuration = RTC_TAMPERPRECHARGEDURATION_4RTCCLK;
+      break;
+    case 8:
+      sTamper.PrechargeDuration = RTC_TAMPERPRECHARGEDURATION_8RTCCLK;
+      break;
+    default:
+      return false;
+  }
+#endif /* RTC_TAMPERFILTER_DISABLE */
+#if defined(RTC_TIMESTAMPONTAMPERDETECTION_ENABLE)
+  sTamper.TimeStampOnTamperDetection = timeStamp ? RTC_TIMESTAMPONTAMPERDETECTION_ENABLE :
+                                       RTC_TIMESTAMPONTAMPERDETECTION_DISABLE;
+#else
+  if (timeStamp) {
+    return false;
+  }
+#endif /* RTC_TIMESTAMPONTAMPERDETECTION_ENABLE */
+#if defined(RTC_TAMPER_ERASE_BACKUP_DISABLE)
+  sTamper.NoErase = noErase ? RTC_TAMPER_ERASE_BACKUP_DISABLE : RTC_TAMPER_ERASE_BACKUP_ENABLE;
+#else
+  if (noErase) {
+    return false;
+  }
+#endif /* RTC_TAMPER_ERASE_BACKUP_DISABLE */
+#if defined(RTC_TAMPERMASK_FLAG_DISABLE)
+  sTamper.MaskFlag = RTC_TAMPERMASK_FLAG_DISABLE;
+#endif
+#if defined(RTC_TAMPERPIN_DEFAULT)
+  sTamper.PinSelection = RTC_TAMPERPIN_DEFAULT;
+#endif
+
+  if (HAL_RTCEx_SetTamper_IT(&RtcHandle, &sTamper) != HAL_OK) {
+    return false;
+  }
+  HAL_NVIC_SetPriority(RTC_TAMPER_IRQn, RTC_IRQ_PRIO, RTC_IRQ_SUBPRIO);
+  HAL_NVIC_EnableIRQ(RTC_TAMPER_IRQn);
+  return true;
+}
+
+/**
+  * @brief Disable a tamper input
+  * @param tamper: tamper input number (1-3 depending on the series)
+  * @retval None
+  */
+void RTC_DisableTamper(uint8_t tamper)
+{
+  switch (tamper) {
+    case 1:
+      HAL_RTCEx_DeactivateTamper(&RtcHandle, RTC_TAMPER_1);
+      break;
+#if defined(RTC_TAMPER_2)
+    case 2:
+      HAL_RTCEx_DeactivateTamper(&RtcHandle, RTC_TAMPER_2);
+      break;
+#endif
+#if defined(RTC_TAMPER_3)
+    case 3:
+      HAL_RTCEx_DeactivateTamper(&RtcHandle, RTC_TAMPER_3);
+      break;
+#endif
+    default:
+      break;
+  }
+}
+
+/**
+  * @brief Get the saved time stamp and clear it
+  * @note  The time stamp registers have no year.
+  * @param month: 1-12
+  * @param day: 1-31
+  * @param hours: 0-12 or 0-23 depends on the hours mode
+  * @param minutes: 0-59
+  * @param seconds: 0-59
+  * @param subSeconds: 0-999
+  * @param period: HOUR_AM or HOUR_PM
+  * @retval true if a time stamp was saved
+  */
+bool RTC_GetTimeStamp(uint8_t *month, uint8_t *day, uint8_t *hours, uint8_t *minutes, uint8_t *seconds, uint32_t *subSeconds, hourAM_PM_t *period)
+{
+  RTC_TimeTypeDef RTC_TimeStruct;
+  RTC_DateTypeDef RTC_DateStruct;
+
+  if (!__HAL_RTC_TIMESTAMP_GET_FLAG(&RtcHandle, RTC_FLAG_TSF)) {
+    return false;
+  }
+  HAL_RTCEx_GetTimeStamp(&RtcHandle, &RTC_TimeStruct, &RTC_DateStruct, RTC_FORMAT_BIN);
+  __HAL_RTC_TIMESTAMP_CLEAR_FLAG(&RtcHandle, RTC_FLAG_TSF);
+  *month = RTC_DateStruct.Month;
+  *day = RTC_DateStruct.Date;
+  *hours = RTC_TimeStruct.Hours;
+  *minutes = RTC_TimeStruct.Minutes;
+  *seconds = RTC_TimeStruct.Seconds;
+  *subSeconds = ((predivSync - RTC_TimeStruct.SubSeconds) * 1000) / (predivSync + 1);
+  *period = (RTC_TimeStruct.TimeFormat == RTC_HOURFORMAT12_PM) ? HOUR_PM : HOUR_AM;
+  return true;
+}
+
+/**
+  * @brief Attach tamper callback, called with the tamper input number.
+  * @param func: pointer to the callback
+  * @param data: user data passed to the callback
+  * @retval None
+  */
+void attachTamperCallback(tamperCallbackPtr func, void *data)
+{
+  RTCTamperCallback = func;
+  tamperCallbackData = data;
+}
+
+/**
+  * @brief Detach tamper callback.
+  * @param None
+  * @retval None
+  */
+void detachTamperCallback(void)
+{
+  RTCTamperCallback = NULL;
+  tamperCallbackData = NULL;
+}
+
+/**
+  * @brief  Tamper 1 callback.
+  * @param  hrtc RTC handle
+  * @retval None
+  */
+void HAL_RTCEx_Tamper1EventCallback(RTC_HandleTypeDef *hrtc)
+{
+  UNUSED(hrtc);
+
+  if (RTCTamperCallback != NULL) {
+    RTCTamperCallback(1, tamperCallbackData);
+  }
+}
+
+#if defined(RTC_TAMPER_2)
+/**
+  * @brief  Tamper 2 callback.
+  * @param  hrtc RTC handle
+  * @retval None
+  */
+void HAL_RTCEx_Tamper2EventCallback(RTC_HandleTypeDef *hrtc)
+{
+  UNUSED(hrtc);
+
+  if (RTCTamperCallback != NULL) {
+    RTCTamperCallback(2, tamperCallbackData);
+  }
+}
+#endif /* RTC_TAMPER_2 */
+
+#if defined(RTC_TAMPER_3)
+/**
+  * @brief  Tamper 3 callback.
+  * @param  hrtc RTC handle
+  * @retval None
+  */
+void HAL_RTCEx_Tamper3EventCallback(RTC_HandleTypeDef *hrtc)
+{
+  UNUSED(hrtc);
+
+  if (RTCTamperCallback != NULL) {
+    RTCTamperCallback(3, tamperCallbackData);
+  }
+}
+#endif /* RTC_TAMPER_3 */
+
+#if defined(RTC_TIMESTAMP_IT)
+/**
+  * @brief Enable the time stamp input (RTC_TS pin) and its interrupt
+  * @param fallingEdge: true to save the time stamp on the falling edge,
+  *                     false on the rising edge
+  * @retval true if the time stamp is enabled
+  */
+bool RTC_EnableTimeStamp(bool fallingEdge)
+{
+  if (HAL_RTCEx_SetTimeStamp_IT(&RtcHandle, fallingEdge ? RTC_TIMESTAMPEDGE_FALLING : RTC_TIMESTAMPEDGE_RISING,
+                                RTC_TIMESTAMPPIN_DEFAULT) != HAL_OK) {
+    return false;
+  }
+  HAL_NVIC_SetPriority(RTC_TAMPER_IRQn, RTC_IRQ_PRIO, RTC_IRQ_SUBPRIO);
+  HAL_NVIC_EnableIRQ(RTC_TAMPER_IRQn);
+  return true;
+}
+
+/**
+  * @brief Disable the time stamp input
+  * @param None
+  * @retval None
+  */
+void RTC_DisableTimeStamp(void)
+{
+  HAL_RTCEx_DeactivateTimeStamp(&RtcHandle);
+}
+
+/**
+  * @brief Get the subseconds of the saved time stamp in RTC ticks and clear it
+  * @note  Only the subseconds register is read: meant to be called from the
+  *        time stamp callback to measure the phase of an edge.
+  * @param ticksPerSecond: number of ticks in one second (optional could be NULL)
+  * @retval number of ticks elapsed in the second at the edge. Can be negative
+  *         after a shift operation.
+  */
+int32_t RTC_GetTimeStampTicks(uint32_t *ticksPerSecond)
+{
+  int32_t ticks = (int32_t)predivSync - (int32_t)(READ_REG(RtcHandle.Instance->TSSSR) & RTC_TSSSR_SS);
+
+  __HAL_RTC_TIMESTAMP_CLEAR_FLAG(&RtcHandle, RTC_FLAG_TSF);
+  if (ticksPerSecond != NULL) {
+    *ticksPerSecond = predivSync + 1;
+  }
+  return ticks;
+}
+
+/**
+  * @brief Attach time stamp callback.
+  * @param func: pointer to the callback
+  * @param data: user data passed to the callback
+  * @retval None
+  */
+void attachTimeStampCallback(voidCallbackPtr func, void *data)
+{
+  RTCTimeStampCallback = func;
+  timeStampCallbackData = data;
+}
+
+/**
+  * @brief Detach time stamp callback.
+  * @param None
+  * @retval None
+  */
+void detachTimeStampCallback(void)
+{
+  RTCTimeStampCallback = NULL;
+  timeStampCallbackData = NULL;
+}
+
+/**
+  * @brief  Time stamp callback.
+  * @param  hrtc RTC handle
+  * @retval None
+  */
+void HAL_RTCEx_TimeStampEventCallback(RTC_HandleTypeDef *hrtc)
+{
+  UNUSED(hrtc);
+
+  if (RTCTimeStampCallback != NULL) {
+    RTCTimeStampCallback(timeStampCallbackData);
+  }
+}
+#endif /* RTC_TIMESTAMP_IT */
+
+/**
+  * @brief  RTC Tamper and time stamp IRQHandler
+  * @param  None
+  * @retval None
+  */
+void RTC_TAMPER_IRQHandler(void)
+{
+  HAL_RTCEx_TamperTimeStampIRQHandler(&RtcHandle);
+}
+#endif /* RTC_TAMPER_IRQn */
+
+#if defined(RTC_SYNCHRO_SHIFT)
+/**
+  * @brief Shift the calendar by a fraction of second
+  * @note  The synchronization shift does not stop the RTC: the subseconds
+  *        counter is advanced by adding one second and removing its
+  *        complement, or delayed. Not available while the reference clock
+  *        detection is enabled.
+  * @param ticks: RTC ticks to add, positive to advance the calendar, lower
+  *               than one second in absolute value
+  * @retval true if the shift has been applied
+  */
+bool RTC_ShiftTicks(int32_t ticks)
+{
+  int32_t ticksPerSecond = (int32_t)predivSync + 1;
+  HAL_StatusTypeDef status;
+
+  if (ticks == 0) {
+    return true;
+  }
+  if ((ticks >= ticksPerSecond) || (ticks <= -ticksPerSecond)) {
+    return false;
+  }
+  if (ticks > 0) {
+    status = HAL_RTCEx_SetSynchroShift(&RtcHandle, RTC_SHIFTADD1S_SET, (uint32_t)(ticksPerSecond - ticks));
+  } else {
+    status = HAL_RTCEx_SetSynchroShift(&RtcHandle, RTC_SHIFTADD1S_RESET, (uint32_t)(-ticks));
+  }
+  return status == HAL_OK;
+}
+#endif /* RTC_SYNCHRO_SHIFT */
+
+/**
+  * @brief Get RTC alarm programming statistics
+  * @param writes: number of times the alarm registers have been programmed
+  *                (optional could be NULL)
+  * @param skipped: number of RTC_StartAlarm() calls skipped because the alarm
+  *                 was already programmed with the same configuration
+  *                 (optional could be NULL)
+  * @retval None
+  */
+void RTC_GetAlarmStats(uint32_t *writes, uint32_t *skipped)
+{
+  if (writes != NULL) {
+    *writes = alarmWriteCount;
+  }
+  if (skipped != NULL) {
+    *skipped = alarmSkipCount;
+  }
 }
 
 /**
@@ -690,7 +1722,8 @@ bool RTC_IsAlarmSet(void)
 
 /**
   * @brief Get RTC alarm
-  * @param day: 1-31 day of the month (optional could be NULL)
+  * @param day: 1-31 day of the month or 1-7 day of the week if WD_MSK is
+  *             returned in mask (optional could be NULL)
   * @param hours: 0-12 or 0-23 depends on the hours mode
   * @param minutes: 0-59
   * @param seconds: 0-59
@@ -742,6 +1775,9 @@ void RTC_GetAlarm(uint8_t *day, uint8_t *hours, uint8_t *minutes, uint8_t *secon
       }
       if (!(RTC_AlarmStructure.AlarmMask & RTC_ALARMMASK_DATEWEEKDAY)) {
         *mask |= D_MSK;
+        if (RTC_AlarmStructure.AlarmDateWeekDaySel == RTC_ALARMDATEWEEKDAYSEL_WEEKDAY) {
+          *mask |= WD_MSK;
+        }
       }
     }
 #else
@@ -900,6 +1936,91 @@ void RTC_WKUP_IRQHandler(void)
 #endif /* STM32F1xx */
 #endif /* ONESECOND_IRQn */
 
+/**
+  * @brief Write a 32 bits word in the backup registers
+  * @note  On STM32F1xx, 2 consecutive 16 bits registers are used
+  * @param index: backup register index (LL_RTC_BKP_DRx)
+  * @param value: value to store
+  * @retval None
+  */
+void RTC_SetBackupWord(uint32_t index, uint32_t value)
+{
+#if defined(STM32F1xx)
+  setBackupRegister(index, value >> 16);
+  setBackupRegister(index + 1, value & 0xFFFF);
+#else
+  setBackupRegister(index, value);
+#endif /* STM32F1xx */
+}
+
+/**
+  * @brief Read a 32 bits word from the backup registers
+  * @note  On STM32F1xx, 2 consecutive 16 bits registers are used
+  * @param index: backup register index (LL_RTC_BKP_DRx)
+  * @retval stored value
+  */
+uint32_t RTC_GetBackupWord(uint32_t index)
+{
+#if defined(STM32F1xx)
+  return (getBackupRegister(index) << 16) | (getBackupRegister(index + 1) & 0xFFFF);
+#else
+  return getBackupRegister(index);
+#endif /* STM32F1xx */
+}
+
+#if defined(BKPSRAM_BASE)
+/**
+  * @brief Enable the backup SRAM: clock and retention in VBAT mode
+  * @note  Only the first call configures it.
+  * @retval backup SRAM base address
+  */
+void *RTC_BkpSramEnable(void)
+{
+  static bool enabled = false;
+
+  if (!enabled) {
+    enableBackupDomain();
+    __HAL_RCC_BKPSRAM_CLK_ENABLE();
+#if defined(PWR_CSR_BRE) || defined(PWR_CSR1_BRE) || defined(PWR_CR2_BREN)
+    /* Backup regulator, waits for it to be ready */
+    HAL_PWREx_EnableBkUpReg();
+#elif defined(PWR_BDCR1_BREN)
+    HAL_PWREx_EnableBkupRAMRetention();
+#endif
+    enabled = true;
+  }
+  return (void *)BKPSRAM_BASE;
+}
+
+/**
+  * @brief Start a write session to the backup SRAM
+  * @retval true if the backup domain write access was already enabled
+  */
+bool RTC_BkpSramWriteBegin(void)
+{
+  bool wasEnabled = LL_PWR_IsEnabledBkUpAccess();
+
+  if (!wasEnabled) {
+    LL_PWR_EnableBkUpAccess();
+  }
+  return wasEnabled;
+}
+
+/**
+  * @brief End a write session to the backup SRAM
+  * @param keepEnabled: value returned by RTC_BkpSramWriteBegin(), the
+  *        backup domain write access is disabled if false
+  * @retval None
+  */
+void RTC_BkpSramWriteEnd(bool keepEnabled)
+{
+  __DSB();
+  if (!keepEnabled) {
+    LL_PWR_DisableBkUpAccess();
+  }
+}
+#endif /* BKPSRAM_BASE */
+
 #if defined(STM32F1xx)
 void RTC_StoreDate(void)
 {
@@ -71,11 +71,46 @@ typedef enum {
   /* NOTE: STM32 RTC can't assign a month or a year to an alarm. Those enum
   are kept for compatibility but are ignored inside enableAlarm(). */
   M_MSK   = 16,
-  Y_MSK   = 32
+  Y_MSK   = 32,
+  /* Compare the day with the week day (1-7) instead of the date. Used with D_MSK */
+  WD_MSK  = 64
 } alarmMask_t;
 
+/* Raw snapshot of the calendar registers, see RTC_GetRawTime() */
+typedef struct {
+  uint32_t time;       /* TR register or seconds counter for STM32F1xx */
+  uint32_t date;       /* DR register or packed date for STM32F1xx */
+  uint32_t subSeconds; /* SSR register or divider for STM32F1xx */
+} rawTime_t;
+
+#if !defined(STM32F1xx)
+/* Alarm A register words, see RTC_BuildAlarmRegs() */
+typedef struct {
+  uint32_t alrmar;
+  uint32_t alrmassr;
+} alarmRegs_t;
+#endif /* !STM32F1xx */
+
 typedef void(*voidCallbackPtr)(void *);
 
+typedef enum {
+  TAMPER_RISING_EDGE,
+  TAMPER_FALLING_EDGE,
+  TAMPER_LOW_LEVEL,
+  TAMPER_HIGH_LEVEL
+} tamperTrigger_t;
+
+typedef void(*tamperCallbackPtr)(uint8_t tamper, void *);
+
+/* Wake up reasons returned by RTC_GetWakeReason() */
+#define RTC_WAKE_NONE       0x00
+#define RTC_WAKE_ALARM_A    0x01
+#define RTC_WAKE_ALARM_B    0x02
+#define RTC_WAKE_TIMER      0x04
+#define RTC_WAKE_TIMESTAMP  0x08
+#define RTC_WAKE_TAMPER     0x10
+#define RTC_WAKE_STANDBY    0x20 /* Resumed from Standby mode */
+
 /* Exported constants --------------------------------------------------------*/
 
 #if defined(STM32F1xx)
@@ -87,6 +122,80 @@ typedef void(*voidCallbackPtr)(void *);
 #endif
 #endif /* STM32F1xx */
 
+/*
+ * Backup registers used by the library to keep data across reset and Standby.
+ * Each one is a 32 bits word: on STM32F1xx it uses 2 consecutive 16 bits
+ * registers (index and index + 1).
+ * They can be changed for your convenience. A feature is disabled if its
+ * register is not defined.
+ * The following features are opt-in, enabled by defining their register
+ * (e.g. in build_opt.h) to one not used by the application:
+ *   RTC_BKP_ALARM_TARGET     missed alarm detection
+ *   RTC_BKP_ALARM_QUEUE      persistent alarm queue (first register)
+ *   RTC_BKP_MONOTONIC_OFFSET monotonic time kept across reset
+ *   RTC_BKP_SYNC_EPOCH and
+ *   RTC_BKP_SYNC_INFO        time quality kept across reset
+ *   RTC_BKP_AGING            aging model kept across reset
+ */
+#if defined(STM32F1xx)
+#define RTC_BKP_WORD_SIZE 2
+#else
+#define RTC_BKP_WORD_SIZE 1
+#endif /* STM32F1xx */
+
+/* The synchronization time is a monotonic time, only valid with its offset */
+#if defined(RTC_BKP_SYNC_EPOCH) && !defined(RTC_BKP_MONOTONIC_OFFSET)
+#error "RTC_BKP_SYNC_EPOCH requires RTC_BKP_MONOTONIC_OFFSET"
+#endif
+/* The aging correction is extrapolated from the synchronization time */
+#if defined(RTC_BKP_AGING) && !defined(RTC_BKP_SYNC_EPOCH)
+#error "RTC_BKP_AGING requires RTC_BKP_SYNC_EPOCH"
+#endif
+
+/* Number of entries of the persistent alarm queue (2 words per entry) */
+#ifndef RTC_ALARM_QUEUE_SIZE
+#define RTC_ALARM_QUEUE_SIZE 4
+#endif
+
+#if defined(RTC_BKP_ALARM_QUEUE)
+/* The queue must not overlap the other backup registers used by the library */
+#define RTC_BKP_ALARM_QUEUE_END (RTC_BKP_ALARM_QUEUE + (RTC_ALARM_QUEUE_SIZE * 2 * RTC_BKP_WORD_SIZE))
+#define RTC_BKP_IN_ALARM_QUEUE(reg) \
+  ((((reg) + RTC_BKP_WORD_SIZE) > RTC_BKP_ALARM_QUEUE) && ((reg) < RTC_BKP_ALARM_QUEUE_END))
+#if (defined(RTC_BKP_DATE) && RTC_BKP_IN_ALARM_QUEUE(RTC_BKP_DATE)) || \
+    (defined(RTC_BKP_AGING) && RTC_BKP_IN_ALARM_QUEUE(RTC_BKP_AGING)) || \
+    (defined(RTC_BKP_SYNC_INFO) && RTC_BKP_IN_ALARM_QUEUE(RTC_BKP_SYNC_INFO)) || \
+    (defined(RTC_BKP_SYNC_EPOCH) && RTC_BKP_IN_ALARM_QUEUE(RTC_BKP_SYNC_EPOCH)) || \
+    (defined(RTC_BKP_MONOTONIC_OFFSET) && RTC_BKP_IN_ALARM_QUEUE(RTC_BKP_MONOTONIC_OFFSET)) || \
+    (defined(RTC_BKP_ALARM_TARGET) && RTC_BKP_IN_ALARM_QUEUE(RTC_BKP_ALARM_TARGET))
+#error "RTC_ALARM_QUEUE_SIZE too large: the alarm queue overlaps another backup register of the library"
+#endif
+#endif /* RTC_BKP_ALARM_QUEUE */
+
+/* Maximum number of entries of the weekly alarm schedule */
+#ifndef RTC_WEEKLY_SCHEDULE_SIZE
+#define RTC_WEEKLY_SCHEDULE_SIZE 8
+#endif
+
+/* Shift of the calendar by a fraction of second */
+#if !defined(STM32F1xx) && defined(RTC_SHIFTR_SUBFS)
+#define RTC_SYNCHRO_SHIFT
+#endif
+
+/* Smooth calibration, or calibration by pulse masking for STM32F1xx */
+#if defined(RTC_CALR_CALP) || defined(STM32F1xx)
+#define RTC_SMOOTH_CALIB
+#endif
+
+/* Size of the backup SRAM */
+#if defined(BKPSRAM_BASE) && !defined(RTC_BKPSRAM_SIZE)
+#if defined(STM32U5xx)
+#define RTC_BKPSRAM_SIZE 2048
+#else
+#define RTC_BKPSRAM_SIZE 4096
+#endif
+#endif /* BKPSRAM_BASE && !RTC_BKPSRAM_SIZE */
+
 /* Interrupt priority */
 #ifndef RTC_IRQ_PRIO
 #define RTC_IRQ_PRIO       2
@@ -155,6 +264,27 @@ typedef void(*voidCallbackPtr)(void *);
 #define IS_RTC_HOUR12(HOUR)      IS_RTC_HOUR24(HOUR)
 #endif /* !STM32F1xx && !IS_RTC_WEEKDAY */
 
+/* Alarm B with subseconds matching is used for the synchronized actions */
+#if !defined(STM32F1xx) && defined(RTC_ALARM_B) && defined(RTC_SSR_SS)
+#define RTC_SYNC_ALARM
+#endif
+
+/* Tamper detection for the series with a dedicated TAMP_STAMP interrupt.
+   TAMP_STAMP_IRQn is an enumerator, not a macro, so it can not be tested
+   with defined(): the series are listed. The other series share the RTC
+   interrupt with the alarms or name it differently and are not supported. */
+#if defined(RTC_TAMPER_1) && (defined(STM32F2xx) || defined(STM32F3xx) || \
+    defined(STM32F4xx) || defined(STM32F7xx) || defined(STM32H7xx) || \
+    defined(STM32L4xx))
+#define RTC_TAMPER_IRQn       TAMP_STAMP_IRQn
+#define RTC_TAMPER_IRQHandler TAMP_STAMP_IRQHandler
+#endif
+
+/* Time stamp input interrupt, shared with the tamper interrupt */
+#if defined(RTC_TAMPER_IRQn) && defined(RTC_TIMESTAMPPIN_DEFAULT)
+#define RTC_TIMESTAMP_IT
+#endif
+
 /* __HAL_RCC_GET_RTC_SOURCE is not defined for F2*/
 /*
 #ifndef __HAL_RCC_GET_RTC_SOURCE
@@ -181,19 +311,58 @@ void RTC_setPrediv(int8_t asynch, int16_t synch);
 bool RTC_init(hourFormat_t format, sourceClock_t source, bool reset);
 void RTC_DeInit(void);
 bool RTC_IsConfigured(void);
+hourFormat_t RTC_GetHourFormat(void);
+uint32_t RTC_GetWakeReason(void);
 
 void RTC_SetTime(uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period);
 void RTC_GetTime(uint8_t *hours, uint8_t *minutes, uint8_t *seconds, uint32_t *subSeconds, hourAM_PM_t *period);
 
 void RTC_SetDate(uint8_t year, uint8_t month, uint8_t day, uint8_t wday);
 void RTC_GetDate(uint8_t *year, uint8_t *month, uint8_t *day, uint8_t *wday);
+uint32_t RTC_GetRawDate(void);
+void RTC_DecodeRawDate(uint32_t rawDate, uint8_t *year, uint8_t *month, uint8_t *day);
+void RTC_GetRawTime(rawTime_t *raw);
+void RTC_DecodeRawTime(const rawTime_t *raw, uint32_t *seconds, int32_t *ticks);
+uint32_t RTC_GetTicksPerSecond(void);
 
 void RTC_StartAlarm(uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask);
 void RTC_StopAlarm(void);
 bool RTC_IsAlarmSet(void);
+void RTC_GetAlarmStats(uint32_t *writes, uint32_t *skipped);
+#if !defined(STM32F1xx)
+bool RTC_BuildAlarmRegs(alarmRegs_t *regs, uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask);
+bool RTC_StartAlarmRegs(const alarmRegs_t *regs);
+#endif /* !STM32F1xx */
 void RTC_GetAlarm(uint8_t *day, uint8_t *hours, uint8_t *minutes, uint8_t *seconds, uint32_t *subSeconds, hourAM_PM_t *period, uint8_t *mask);
 void attachAlarmCallback(voidCallbackPtr func, void *data);
 void detachAlarmCallback(void);
+#if defined(RTC_SYNC_ALARM)
+void RTC_StartAlarmB(uint8_t day, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t subSeconds, hourAM_PM_t period, uint8_t mask);
+void RTC_StopAlarmB(void);
+uint32_t RTC_GetSubSecondTicks(uint32_t *ticksPerSecond);
+void attachAlarmBCallback(voidCallbackPtr func, void *data);
+void detachAlarmBCallback(void);
+#endif /* RTC_SYNC_ALARM */
+#if defined(RTC_TAMPER_IRQn)
+bool RTC_EnableTamper(uint8_t tamper, tamperTrigger_t trigger, uint8_t filter, uint16_t samplingDiv, uint8_t precharge, bool timeStamp, bool noErase);
+void RTC_DisableTamper(uint8_t tamper);
+bool RTC_GetTimeStamp(uint8_t *month, uint8_t *day, uint8_t *hours, uint8_t *minutes, uint8_t *seconds, uint32_t *subSeconds, hourAM_PM_t *period);
+void attachTamperCallback(tamperCallbackPtr func, void *data);
+void detachTamperCallback(void);
+#endif /* RTC_TAMPER_IRQn */
+#if defined(RTC_TIMESTAMP_IT)
+bool RTC_EnableTimeStamp(bool fallingEdge);
+void RTC_DisableTimeStamp(void);
+int32_t RTC_GetTimeStampTicks(uint32_t *ticksPerSecond);
+void attachTimeStampCallback(voidCallbackPtr func, void *data);
+void detachTimeStampCallback(void);
+#endif /* RTC_TIMESTAMP_IT */
+#if defined(RTC_SYNCHRO_SHIFT)
+bool RTC_ShiftTicks(int32_t ticks);
+#endif /* RTC_SYNCHRO_SHIFT */
+uint32_t RTC_GetClockFrequency(void);
+int32_t RTC_SetCalibration(int32_t ppb);
+int32_t RTC_GetCalibration(void);
 #ifdef ONESECOND_IRQn
 void attachSecondsIrqCallback(voidCallbackPtr func);
 void detachSecondsIrqCallback(void);
@@ -203,6 +372,15 @@ void detachSecondsIrqCallback(void);
 void RTC_StoreDate(void);
 #endif
 
+void RTC_SetBackupWord(uint32_t index, uint32_t value);
+uint32_t RTC_GetBackupWord(uint32_t index);
+
+#if defined(BKPSRAM_BASE)
+void *RTC_BkpSramEnable(void);
+bool RTC_BkpSramWriteBegin(void);
+void RTC_BkpSramWriteEnd(bool keepEnabled);
+#endif /* BKPSRAM_BASE */
+
 #ifdef __cplusplus
 }
 #endif